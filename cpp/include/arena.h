@@ -0,0 +1,96 @@
+/**
+ * @file arena.h
+ * @brief Bump allocator for per-frame transient buffers, reset between frames
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @class FrameArena
+ * @brief Hands out memory from large blocks that are released all at once
+ *
+ * Allocations are never freed individually; reset() rewinds the arena and
+ * coalesces its blocks, so after the first few frames every frame is served
+ * from a single block without touching the system allocator.
+ */
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t blockSize = size_t(1) << 20);
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /**
+     * @brief Allocates size bytes aligned for any scalar type
+     */
+    void *allocate(size_t size);
+
+    /**
+     * @brief Grows an allocation, in place when it is the most recent one
+     */
+    void *reallocate(void *pointer, size_t oldSize, size_t newSize);
+
+    /**
+     * @brief Checks whether a pointer was allocated from this arena
+     */
+    bool owns(const void *pointer) const;
+
+    /**
+     * @brief Releases all allocations while keeping the reserved memory
+     */
+    void reset();
+
+    /**
+     * @brief Total bytes reserved by the arena
+     */
+    size_t capacity() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+        size_t offset;
+    };
+
+    std::vector<Block> mBlocks;
+    size_t mBlockSize;
+    unsigned char *mLast = nullptr; ///< Most recent allocation, which can grow in place
+};
+
+/**
+ * @class ArenaScope
+ * @brief Routes arenaMalloc/arenaRealloc/arenaFree on the calling thread to an arena
+ */
+class ArenaScope
+{
+public:
+    explicit ArenaScope(FrameArena &arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    FrameArena *mPrevious;
+};
+
+/**
+ * @brief malloc replacement using the thread's bound arena, if any
+ */
+void *arenaMalloc(size_t size);
+
+/**
+ * @brief realloc replacement using the thread's bound arena, if any
+ */
+void *arenaRealloc(void *pointer, size_t oldSize, size_t newSize);
+
+/**
+ * @brief free replacement; arena memory is only released by FrameArena::reset
+ */
+void arenaFree(void *pointer);
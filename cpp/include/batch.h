@@ -0,0 +1,31 @@
+/**
+ * @file batch.h
+ * @brief Conversion of many shots listed in a manifest on one frame pipeline
+ *
+ * Each non-empty manifest line holds the options of one shot, separated by
+ * whitespace; lines starting with # are comments. A shot's options are
+ * applied after those of the command line, so the command line sets the
+ * defaults of every shot. --jobs, --threads, --decode-jobs, --voxelize-jobs,
+ * --write-jobs, --memory-budget, --io-jobs and --numa apply to the whole
+ * batch and are taken from the command line only.
+ */
+
+#pragma once
+
+#include "options.h"
+
+#include <string>
+
+/**
+ * @brief Converts every shot of a manifest and prints per-shot statistics
+ *
+ * Frames of all shots share the stages of runFramePipeline, started
+ * round-robin across the shots so each one progresses at the same rate. A
+ * frame that fails is counted and the batch continues.
+ *
+ * @param options Options of the command line
+ * @param argc Argument count of the command line
+ * @param argv Arguments of the command line, which shot lines extend
+ * @return false if a shot could not be set up or a frame failed
+ */
+bool runBatch(const ProgramOptions &options, int argc, const char *const argv[]);
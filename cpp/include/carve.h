@@ -0,0 +1,35 @@
+/**
+ * @file carve.h
+ * @brief Space-carving reconstruction of a solid volume from the depth views
+ */
+
+#pragma once
+
+#include "views.h"
+
+#include <openvdb/openvdb.h>
+#include <vector>
+
+/**
+ * @brief Carves a solid density volume out of the textureSize^3 domain
+ *
+ * Each view turns its depth map into one occupancy interval per pixel,
+ * [surface depth, far end]. A voxel is inside when it projects into every
+ * loaded view and falls within the interval of the pixel it projects to;
+ * background pixels have an empty interval.
+ * Inside voxels take the color of the view whose surface is closest to them.
+ * The domain is processed in parallel over z-slabs.
+ *
+ * @param views Decoded views, one per rig camera; empty views are ignored
+ * @param rig Camera rig the views were rendered from
+ * @param textureSize Size of the texture (assumed square)
+ * @param rgbGrid Output color grid
+ * @param alphaGrid Output density grid (1 inside)
+ * @param verbose Enable verbose logging
+ */
+void carveVolume(const std::vector<DepthView> &views,
+                 const CameraRig &rig,
+                 int textureSize,
+                 openvdb::Vec3fGrid::Ptr rgbGrid,
+                 openvdb::FloatGrid::Ptr alphaGrid,
+                 bool verbose);
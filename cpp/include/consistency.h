@@ -0,0 +1,38 @@
+/**
+ * @file consistency.h
+ * @brief Multi-view consistency filtering of reconstructed surface voxels
+ */
+
+#pragma once
+
+#include "rig.h"
+#include "views.h"
+
+#include <openvdb/openvdb.h>
+#include <vector>
+
+/**
+ * @brief Removes voxels that too few views agree with
+ *
+ * Every active voxel is reprojected into each loaded view. A view agrees
+ * when the voxel lies within the tolerance of its surface at that pixel.
+ * Only agreement is counted, so views where the voxel is hidden behind
+ * another surface do not penalize it. Floaters from bad depth pixels are
+ * removed because only their source view agrees with them. Runs in parallel
+ * over the active leaves.
+ *
+ * @param views Decoded views, one per rig camera; empty views are ignored
+ * @param rig Camera rig the views were rendered from
+ * @param minViews Number of agreeing views required to keep a voxel
+ * @param tolerance Maximum distance to a view's surface in voxels
+ * @param rgbGrid Color grid, filtered alongside alphaGrid
+ * @param alphaGrid Grid whose active voxels are tested
+ * @param verbose Enable verbose logging
+ */
+void filterConsistentVoxels(const std::vector<DepthView> &views,
+                            const CameraRig &rig,
+                            int minViews,
+                            float tolerance,
+                            openvdb::Vec3fGrid::Ptr rgbGrid,
+                            openvdb::FloatGrid::Ptr alphaGrid,
+                            bool verbose);
@@ -0,0 +1,267 @@
+/**
+ * @file convert.h
+ * @brief Per-frame reconstruction and the frame pipeline driving it
+ */
+
+#pragma once
+
+#include "options.h"
+#include "rig.h"
+#include "views.h"
+#include "arena.h"
+#include "memusage.h"
+#include "mesh.h"
+
+#include <openvdb/openvdb.h>
+#include <openvdb/math/Transform.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct FrameWorkspace
+ * @brief Buffers of one frame in flight, reused by the frames that follow it
+ */
+struct FrameWorkspace
+{
+    const ProgramOptions *options = nullptr;              ///< Options the frame is converted with
+    const CameraRig *rig = nullptr;                       ///< Rig of the frame's views
+    size_t source = 0;                                    ///< Caller's index of the sequence holding the frame
+    int frame = 0;                                        ///< Frame being converted
+    bool failed = false;                                  ///< Set when a stage failed; later stages skip the frame
+    std::string error;                                    ///< Reason of the failure
+    std::chrono::steady_clock::time_point start;          ///< When the frame entered the decode stage
+    int numaNode = 0;                                     ///< Node whose arena runs the frame with --numa
+    std::vector<std::vector<unsigned char>> encodedViews; ///< Encoded view images of the frame
+    std::vector<std::unique_ptr<FrameArena>> arenas;      ///< Image decode buffers of each view, reset once decoded
+    std::vector<DepthView> views;                         ///< Decoded views
+    std::vector<VoxelData> voxelDataList;                 ///< First-surface samples
+    openvdb::Vec3fGrid::Ptr rgbGrid;                      ///< Color grid kept for the next frame with --reuse-grids
+    openvdb::FloatGrid::Ptr alphaGrid;                    ///< Alpha grid kept for the next frame with --reuse-grids
+    openvdb::GridPtrVec grids;                            ///< Output grids, from reconstruction until written
+    openvdb::FloatGrid::Ptr levelSetGrid;                 ///< Level set of the surface, if one is built
+    openvdb::math::Transform::Ptr transform;              ///< World transform of the grids
+    SurfaceMesh mesh;                                     ///< Extracted mesh with --mesh
+    FrameMemory memory;                                   ///< Footprint of the last frame
+};
+
+/**
+ * @struct WorkspacePool
+ * @brief Fixed set of workspaces shared by the frames in flight
+ */
+struct WorkspacePool
+{
+    std::vector<std::unique_ptr<FrameWorkspace>> workspaces;
+    std::vector<FrameWorkspace *> available;
+    std::mutex mutex;
+    std::condition_variable released;
+
+    /**
+     * @param count Number of workspaces
+     * @param nodeCount Number of NUMA nodes the workspaces are spread across
+     */
+    explicit WorkspacePool(int count, int nodeCount = 1)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            workspaces.emplace_back(new FrameWorkspace());
+            workspaces.back()->numaNode = i % nodeCount;
+            available.push_back(workspaces.back().get());
+        }
+    }
+
+    /**
+     * @brief Takes a workspace of the node with the most idle workspaces, so frames spread over the nodes
+     *
+     * Blocks until a workspace is released if all of them are in use.
+     */
+    FrameWorkspace *acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [this]() { return !available.empty(); });
+
+        std::vector<int> idle;
+        for (const FrameWorkspace *workspace : available)
+        {
+            idle.resize(std::max<size_t>(idle.size(), workspace->numaNode + 1), 0);
+            idle[workspace->numaNode]++;
+        }
+
+        size_t chosen = available.size() - 1;
+        for (size_t i = 0; i < available.size(); i++)
+        {
+            if (idle[available[i]->numaNode] > idle[available[chosen]->numaNode])
+            {
+                chosen = i;
+            }
+        }
+
+        FrameWorkspace *workspace = available[chosen];
+        available.erase(available.begin() + chosen);
+        return workspace;
+    }
+
+    void release(FrameWorkspace *workspace)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            available.push_back(workspace);
+        }
+        released.notify_one();
+    }
+};
+
+/**
+ * @class IoLimiter
+ * @brief Caps the number of frames reading or writing files at once
+ */
+class IoLimiter
+{
+public:
+    /**
+     * @param limit Frames allowed in I/O at once, 0 for no limit
+     */
+    explicit IoLimiter(int limit);
+
+    void acquire();
+    void release();
+
+private:
+    int mLimit;
+    int mActive = 0;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+/**
+ * @class IoScope
+ * @brief Holds an I/O slot for the lifetime of a scope
+ *
+ * Scopes cover plain reads and writes only. A thread waiting inside a
+ * parallel algorithm may run another frame's stage, which would block on
+ * the slot its own frame holds.
+ */
+class IoScope
+{
+public:
+    explicit IoScope(IoLimiter &limiter);
+    ~IoScope();
+
+    IoScope(const IoScope &) = delete;
+    IoScope &operator=(const IoScope &) = delete;
+
+private:
+    IoLimiter &mLimiter;
+};
+
+/**
+ * @brief Decodes the views of workspace.frame into workspace.views
+ *
+ * Views decode concurrently, each with its own arena. Throws
+ * std::runtime_error if any view cannot be read or decoded, so a frame is
+ * never reconstructed from part of its views.
+ *
+ * @param options Conversion options
+ * @param rig Camera rig of the views
+ * @param workspace Workspace of the frame
+ * @param io Limiter held while the views are read
+ */
+void decodeFrame(const ProgramOptions &options, const CameraRig &rig, FrameWorkspace &workspace, IoLimiter &io);
+
+/**
+ * @brief Builds the grids, level set and mesh of a decoded frame
+ * @param options Conversion options
+ * @param rig Camera rig of the views
+ * @param workspace Workspace of the frame, receiving the reconstruction and its memory footprint
+ */
+void reconstructFrame(const ProgramOptions &options, const CameraRig &rig, FrameWorkspace &workspace);
+
+/**
+ * @brief Writes the outputs of a reconstructed frame and releases its grids
+ * @param options Conversion options
+ * @param workspace Workspace of the frame
+ * @param io Limiter held while each output is written
+ */
+void writeFrame(const ProgramOptions &options, FrameWorkspace &workspace, IoLimiter &io);
+
+/**
+ * @struct FrameRequest
+ * @brief Next frame to convert, filled in by the frame source of runFramePipeline
+ */
+struct FrameRequest
+{
+    const ProgramOptions *options = nullptr;              ///< Options the frame is converted with
+    const CameraRig *rig = nullptr;                       ///< Rig of the frame's views
+    size_t source = 0;                                    ///< Caller's index of the sequence holding the frame
+    int frame = 0;                                        ///< Frame number
+    std::vector<std::vector<unsigned char>> encodedViews; ///< View images read from the input stream
+};
+
+/**
+ * @struct FrameResult
+ * @brief Outcome of one frame of runFramePipeline
+ */
+struct FrameResult
+{
+    size_t source = 0;                                 ///< Index given in the frame's request
+    int frame = 0;                                     ///< Frame number
+    bool failed = false;                               ///< The frame was not written
+    std::string error;                                 ///< Reason of the failure
+    size_t frameBytes = 0;                             ///< Memory footprint of the frame
+    std::chrono::steady_clock::time_point start;       ///< When the frame entered the decode stage
+    std::chrono::steady_clock::time_point finish;      ///< When the frame left the write stage
+};
+
+/**
+ * @brief Runs frames through the decode, voxelize and write stages of a flow graph
+ *
+ * Frames are admitted by a thread of its own, which calls nextFrame and
+ * waits for the memory budget and a free workspace. Blocking reads and
+ * waits therefore never hold a thread of the graph. Up to settings.jobs
+ * frames are in flight at once, and each stage runs at most its own number
+ * of frames at once. A frame whose stage throws is skipped by the later
+ * stages and reported as failed.
+ *
+ * Must not be called from a TBB task, since the calling thread runs stages
+ * while it waits for the graph.
+ *
+ * @param settings Options of the pipeline: --jobs, the per-stage jobs, --memory-budget, --io-jobs and --numa
+ * @param nextFrame Fills in the next frame; returning false ends the input.
+ *                  The request's encodedViews come back holding the buffers of an earlier frame.
+ * @param frameDone Called once per frame, from one thread at a time and in completion order;
+ *                  returning false stops admitting frames
+ */
+void runFramePipeline(const ProgramOptions &settings,
+                      const std::function<bool(FrameRequest &)> &nextFrame,
+                      const std::function<bool(const FrameResult &)> &frameDone);
+
+/**
+ * @brief Checks the input directory and loads the camera rig of a conversion
+ * @param options Conversion options
+ * @param rig Loaded rig, the six-view cube unless --rig is given
+ * @param errors Stream receiving the reason of a failure
+ * @return false if the conversion cannot start
+ */
+bool setupConversion(const ProgramOptions &options, CameraRig &rig, std::ostream &errors);
+
+/**
+ * @brief Converts the frame range, the frames arriving in watch mode or the frames of the input stream
+ *
+ * The frames run through runFramePipeline.
+ *
+ * @param options Conversion options
+ * @param rig Camera rig of the views
+ * @param frameDone Called after each frame, written or failed; returning false stops the conversion
+ * @param cancelled Checked before each new frame and regularly while watch mode waits for one;
+ *                  returning true stops the conversion
+ * @return false if the frames could not be obtained or the input stream is malformed
+ */
+bool convertFrames(const ProgramOptions &options, const CameraRig &rig,
+                   const std::function<bool(const FrameResult &)> &frameDone,
+                   const std::function<bool()> &cancelled);
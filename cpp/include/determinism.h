@@ -0,0 +1,135 @@
+/**
+ * @file determinism.h
+ * @brief Reproducible parallel sums and VDB output independent of the thread count
+ */
+
+#pragma once
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tree/LeafManager.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/partitioner.h>
+#include <string>
+
+/**
+ * @struct SummationOptions
+ * @brief How parallel accumulations add up their samples
+ */
+struct SummationOptions
+{
+    bool deterministic = false; ///< Split ranges and join partial sums in an order fixed by the range alone
+    bool compensated = false;   ///< Carry Kahan compensation terms alongside the sums
+};
+
+/**
+ * @brief Runs a tbb::parallel_reduce body over a range
+ *
+ * The fast path lets the scheduler choose the split points, so the order in
+ * which floating-point partial sums are joined depends on timing. The
+ * deterministic path splits the range down to its grain size and joins the
+ * pieces in the same tree whatever the number of threads.
+ */
+template <typename Value, typename Body>
+void reduceRange(const tbb::blocked_range<Value> &range, Body &body, const SummationOptions &summation)
+{
+    if (summation.deterministic)
+    {
+        tbb::parallel_deterministic_reduce(range, body, tbb::simple_partitioner());
+    }
+    else
+    {
+        tbb::parallel_reduce(range, body);
+    }
+}
+
+/**
+ * @brief Adds value to sum, keeping the rounding error of the addition in error
+ */
+template <typename Value>
+inline void compensatedAdd(Value &sum, Value &error, const Value &value)
+{
+    const Value corrected = value - error;
+    const Value total = sum + corrected;
+    error = (total - sum) - corrected;
+    sum = total;
+}
+
+/**
+ * @brief Adds value to the voxel ijk of a sum grid and its compensation grid
+ */
+template <typename SumAccessor, typename ErrorAccessor, typename Value>
+inline void compensatedAccumulate(SumAccessor &sums, ErrorAccessor &errors, const openvdb::Coord &ijk,
+                                  const Value &value)
+{
+    Value sum = sums.getValue(ijk);
+    Value error = errors.getValue(ijk);
+    compensatedAdd(sum, error, value);
+    sums.setValue(ijk, sum);
+    errors.setValue(ijk, error);
+}
+
+/**
+ * @brief Adds another partial sum grid and its compensation into a sum grid
+ *
+ * Activates the same voxels as openvdb::tools::compSum.
+ */
+template <typename GridType>
+void compensatedJoin(GridType &sums, GridType &errors, const GridType &otherSums, const GridType &otherErrors)
+{
+    auto sumAccessor = sums.getAccessor();
+    auto errorAccessor = errors.getAccessor();
+    auto otherErrorAccessor = otherErrors.getConstAccessor();
+
+    for (auto iter = otherSums.cbeginValueOn(); iter; ++iter)
+    {
+        const openvdb::Coord ijk = iter.getCoord();
+        compensatedAccumulate(sumAccessor, errorAccessor, ijk, *iter);
+
+        // The other sum's own compensation still has to be subtracted
+        errorAccessor.setValue(ijk, errorAccessor.getValue(ijk) + otherErrorAccessor.getValue(ijk));
+    }
+}
+
+/**
+ * @brief Subtracts the remaining compensation from the active voxels of a sum grid
+ */
+template <typename GridType>
+void foldCompensation(GridType &sums, const GridType &errors)
+{
+    const auto &errorTree = errors.tree();
+    openvdb::tree::LeafManager<typename GridType::TreeType> leafManager(sums.tree());
+
+    leafManager.foreach(
+        [&](typename GridType::TreeType::LeafNodeType &leaf, size_t)
+        {
+            const auto *errorLeaf = errorTree.probeConstLeaf(leaf.origin());
+            if (!errorLeaf)
+            {
+                return;
+            }
+
+            for (auto iter = leaf.beginValueOn(); iter; ++iter)
+            {
+                iter.setValue(*iter - errorLeaf->getValue(iter.pos()));
+            }
+        });
+}
+
+/**
+ * @brief Replaces the random UUID in the header of serialized VDB bytes with one derived from the grids
+ *
+ * OpenVDB stamps every archive with a new random UUID, so two writes of the
+ * same grids differ. The replacement is a hash of the bytes after the
+ * header, so identical grids give identical files while different grids
+ * still get different UUIDs.
+ *
+ * @return false if the bytes do not start with a VDB header holding a UUID
+ */
+bool stabilizeArchiveBytes(std::string &bytes);
+
+/**
+ * @brief Replaces the random UUID in the header of a written .vdb file with one derived from the grids
+ * @return false if the file cannot be patched
+ */
+bool stabilizeArchiveFile(const std::string &path);
@@ -0,0 +1,22 @@
+/**
+ * @file levelset.h
+ * @brief Narrow-band level set construction from reconstructed grids
+ */
+
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+/**
+ * @brief Builds a narrow-band level set from a reconstructed grid
+ *
+ * Level set inputs (e.g. the fused TSDF) are rebuilt around their zero
+ * crossing with the requested band width. Any other grid is converted from
+ * its active topology, so the occupied voxels become the interior.
+ *
+ * @param grid Source grid, either a level set or a density/alpha grid
+ * @param bandWidth Half width of the narrow band in voxels
+ * @param verbose Enable verbose logging
+ * @return Level set grid tagged with the GRID_LEVEL_SET class
+ */
+openvdb::FloatGrid::Ptr buildLevelSet(const openvdb::FloatGrid &grid, int bandWidth, bool verbose);
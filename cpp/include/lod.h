@@ -0,0 +1,23 @@
+/**
+ * @file lod.h
+ * @brief Downsampled level-of-detail grids stored alongside the full resolution ones
+ */
+
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+/**
+ * @brief Appends a pyramid of 2x, 4x, 8x... downsampled copies of the frame's grids
+ *
+ * Each level halves the resolution of the previous one with a 2x2x2 box
+ * filter evaluated in parallel over the coarse leaf nodes. 'Alpha' is
+ * averaged as a density, 'RGB' is averaged with alpha weights, and 'SDF'
+ * averages the active distances. Level k grids are named e.g. 'RGB_lod<k>'
+ * and their transforms are scaled so they overlap the full resolution grids.
+ *
+ * @param grids Frame grids; the LOD grids are appended
+ * @param levels Number of levels to build
+ * @param verbose Enable verbose logging
+ */
+void appendLodGrids(openvdb::GridPtrVec &grids, int levels, bool verbose);
@@ -0,0 +1,67 @@
+/**
+ * @file memusage.h
+ * @brief Per-frame memory accounting and frame throttling under a memory budget
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+/**
+ * @struct FrameMemory
+ * @brief Bytes held by the main structures of one frame
+ */
+struct FrameMemory
+{
+    size_t views = 0;   ///< Decoded depth, color and tile buffers
+    size_t samples = 0; ///< First-surface sample list
+    size_t arena = 0;   ///< Image decode arena
+    size_t grids = 0;   ///< Output grids, as reported by memUsage()
+
+    size_t total() const { return views + samples + arena + grids; }
+};
+
+/**
+ * @brief Peak resident set size of the process in bytes
+ */
+size_t peakRssBytes();
+
+/**
+ * @brief Formats a byte count in MB for reports
+ */
+double toMegabytes(size_t bytes);
+
+/**
+ * @class FrameThrottle
+ * @brief Admits frames only while their estimated footprint fits in a memory budget
+ *
+ * The footprint of a frame is estimated from the largest frame finished so
+ * far, on top of the memory in use before the first frame. Until a frame has
+ * finished, only one frame is admitted at a time. A zero budget admits every
+ * frame.
+ */
+class FrameThrottle
+{
+public:
+    explicit FrameThrottle(size_t budgetBytes);
+
+    /**
+     * @brief Blocks until one more frame fits in the budget
+     */
+    void acquire();
+
+    /**
+     * @brief Marks a frame as finished and records its footprint
+     */
+    void release(size_t frameBytes);
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    size_t mBudget;
+    size_t mBaseline;
+    size_t mEstimate = 0;
+    int mInFlight = 0;
+};
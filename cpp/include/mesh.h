@@ -0,0 +1,49 @@
+/**
+ * @file mesh.h
+ * @brief Surface mesh extraction and export (binary PLY or OBJ)
+ */
+
+#pragma once
+
+#include <openvdb/openvdb.h>
+#include <string>
+#include <vector>
+
+/**
+ * @struct SurfaceMesh
+ * @brief Polygonal surface with per-vertex colors, in world space
+ */
+struct SurfaceMesh
+{
+    std::vector<openvdb::Vec3s> points;    ///< Vertex positions
+    std::vector<openvdb::Vec3f> colors;    ///< RGB color per vertex
+    std::vector<openvdb::Vec3I> triangles; ///< Triangle vertex indices
+    std::vector<openvdb::Vec4I> quads;     ///< Quad vertex indices
+};
+
+/**
+ * @brief Extracts the zero isosurface of a level set and colors it from the RGB grid
+ *
+ * Vertex colors are trilinear samples of the active RGB voxels around each
+ * vertex, so background voxels do not darken the surface.
+ *
+ * @param levelSet Level set grid to mesh
+ * @param rgbGrid Color grid sharing the level set's transform
+ * @param adaptivity Polygon reduction in [0, 1]; 0 keeps a uniform mesh
+ * @param mesh Output mesh
+ */
+void extractMesh(const openvdb::FloatGrid &levelSet,
+                 const openvdb::Vec3fGrid &rgbGrid,
+                 double adaptivity,
+                 SurfaceMesh &mesh);
+
+/**
+ * @brief Writes a mesh as binary PLY or ASCII OBJ depending on the file extension
+ *
+ * A mesh without polygons is written as a colored point cloud.
+ *
+ * @param path Output path ending in .ply or .obj
+ * @param mesh Mesh to write
+ * @return true if the file was written
+ */
+bool writeMesh(const std::string &path, const SurfaceMesh &mesh);
@@ -0,0 +1,77 @@
+/**
+ * @file numa.h
+ * @brief Placement of each frame's work on the threads of one NUMA node
+ */
+
+#pragma once
+
+#include <tbb/task_arena.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * @class NumaPlacement
+ * @brief Runs the work of a frame in a task arena bound to one NUMA node
+ *
+ * Each node gets an arena whose threads are pinned to the node's cores.
+ * Memory is placed on the node of the thread that first touches it, so a
+ * frame whose stages all run in one arena keeps its views, samples and
+ * trees node-local. Without placement, or when oneTBB finds a single node
+ * (or was built without hwloc support), work runs on the calling thread's
+ * arena.
+ */
+class NumaPlacement
+{
+public:
+    /**
+     * @param enabled Create one arena per NUMA node
+     */
+    explicit NumaPlacement(bool enabled);
+
+    /**
+     * @brief Number of nodes frames are spread across, 1 without placement
+     */
+    int nodeCount() const { return mArenas.empty() ? 1 : static_cast<int>(mArenas.size()); }
+
+    /**
+     * @brief Runs function, and the parallel work it starts, on the threads of a node
+     */
+    template <typename Function>
+    void execute(int node, Function &&function)
+    {
+        if (mArenas.empty())
+        {
+            function();
+        }
+        else
+        {
+            mArenas[node]->execute(std::forward<Function>(function));
+        }
+    }
+
+    /**
+     * @brief Records a frame that ran on a node with the given footprint
+     */
+    void recordFrame(int node, size_t frameBytes);
+
+    /**
+     * @brief Prints the frames and bytes kept on each node
+     *
+     * Without placement, threads and pages of a frame are spread over all
+     * nodes, so about (nodes - 1) / nodes of its footprint is accessed
+     * across nodes. That share of the node-local bytes is reported as the
+     * cross-node traffic avoided; it is an estimate, not a measurement.
+     */
+    void report(std::ostream &out) const;
+
+private:
+    std::vector<int> mNodeIds;
+    std::vector<std::unique_ptr<tbb::task_arena>> mArenas;
+    std::vector<int> mFrames;
+    std::vector<size_t> mBytes;
+    mutable std::mutex mMutex;
+};
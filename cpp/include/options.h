@@ -0,0 +1,94 @@
+/**
+ * @file options.h
+ * @brief Conversion options and their command line parsing
+ */
+
+#pragma once
+
+#include "splat.h"
+#include "determinism.h"
+#include "views.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+/**
+ * @enum ReconstructionMode
+ * @brief How the depth views are turned into a volume
+ */
+enum class ReconstructionMode
+{
+    Surface, ///< First-surface point per pixel (hollow shell)
+    Carve,   ///< Space carving of the textureSize^3 domain (solid volume)
+    Tsdf     ///< Truncated signed distance fusion (narrow-band level set)
+};
+
+/**
+ * @struct ProgramOptions
+ * @brief Configuration options for the program
+ */
+struct ProgramOptions
+{
+    int startFrame = 1;
+    int endFrame = 40;
+    std::string baseDir = "../textures/viewdepthmaps/";
+    std::string outputDir = "../output/";
+    std::string outputPrefix = "volume";
+    int textureSize = 256;
+    std::string rigPath;
+    DepthWindow depthWindow;
+    bool adaptiveDepth = false;
+    ReconstructionMode mode = ReconstructionMode::Surface;
+    float truncation = 3.0f;
+    bool levelSet = false;
+    int bandWidth = 3;
+    std::string meshPath;
+    double adaptivity = 0.0;
+    std::string pointsPath;
+    bool splat = false;
+    SplatKernel splatKernel = SplatKernel::Trilinear;
+    int splatRadius = 1;
+    int lodLevels = 0;
+    int consistencyViews = 0;
+    float consistencyTolerance = 1.5f;
+    int jobs = 1;
+    int threads = 0;
+    bool reuseGrids = false;
+    size_t memoryBudget = 0;
+    bool memoryReport = false;
+    int ioJobs = 0;
+    int decodeJobs = 0;
+    int voxelizeJobs = 0;
+    int writeJobs = 0;
+    bool numa = false;
+    SummationOptions summation;
+    bool watch = false;
+    int watchSettle = 500;
+    std::string shmInput;
+    std::string shmOutput;
+    bool streamInput = false;
+    bool streamOutput = false;
+    std::string batchManifest;
+    std::string serverSocket;
+    int serverJobs = 2;
+    bool verbose = false;
+    bool help = false;
+};
+
+/**
+ * @brief Parses command line arguments into conversion options
+ * @param argc Argument count
+ * @param argv Argument values, argv[0] being the program name
+ * @param options Parsed options, starting from the defaults
+ * @param errors Stream receiving the reason of a failure
+ * @return false if an argument is invalid
+ */
+bool parseOptions(int argc, const char *const argv[], ProgramOptions &options, std::ostream &errors);
+
+/**
+ * @brief Writes the option summary shown by --help
+ * @param out Output stream
+ * @param program Program name shown in the usage line
+ */
+void printUsage(std::ostream &out, const std::string &program);
@@ -0,0 +1,57 @@
+/**
+ * @file pointcloud.h
+ * @brief Export of the raw colored view samples as a point cloud
+ */
+
+#pragma once
+
+#include "mesh.h"
+#include "views.h"
+
+#include <openvdb/openvdb.h>
+#include <openvdb/points/PointDataGrid.h>
+#include <string>
+#include <vector>
+
+/**
+ * @struct PointCloud
+ * @brief View samples in world space, ready to be written
+ */
+struct PointCloud
+{
+    SurfaceMesh samples;                      ///< Positions and colors, as a mesh without polygons
+    openvdb::points::PointDataGrid::Ptr grid; ///< Bucketed points, built for .vdb output only
+};
+
+/**
+ * @brief Converts the view samples into the point cloud written to a path
+ *
+ * Points keep the unquantized positions at which the view pixels were
+ * unprojected, not the centers of the voxels they fall in. For a .vdb path
+ * the points are bucketed into leaves in parallel by a point index grid and
+ * stored in a 'Points' grid whose positions are compressed to 16-bit fixed
+ * point within their voxel, with the colors in a 'Cd' attribute.
+ *
+ * @param path Output path ending in .vdb or .ply
+ * @param voxelDataList Samples, whose unquantized positions are in grid index space
+ * @param transform Index-to-world transform of the frame's grids
+ * @param cloud Output point cloud
+ * @return false if the path has an unsupported extension
+ */
+bool buildPointCloud(const std::string &path,
+                     const std::vector<VoxelData> &voxelDataList,
+                     const openvdb::math::Transform::Ptr &transform,
+                     PointCloud &cloud);
+
+/**
+ * @brief Writes a point cloud as an OpenVDB PointDataGrid or a binary PLY with vertex colors
+ *
+ * Only writes the file, so it can run under an I/O limit apart from the
+ * parallel work of buildPointCloud.
+ *
+ * @param path Output path the cloud was built for
+ * @param cloud Point cloud from buildPointCloud
+ * @param verbose Enable verbose logging
+ * @return true if the file was written
+ */
+bool writePointCloud(const std::string &path, const PointCloud &cloud, bool verbose);
@@ -0,0 +1,199 @@
+/**
+ * @file rig.h
+ * @brief Camera rigs: per-view file patterns, intrinsics and camera-to-grid transforms
+ *
+ * Camera space follows image conventions: +X along pixel columns, +Y along
+ * pixel rows and +Z along the viewing direction. A view's normalized depth d
+ * decodes to camera depth (distance along +Z) according to its DepthEncoding.
+ */
+
+#pragma once
+
+#include <openvdb/openvdb.h>
+#include <string>
+#include <vector>
+
+/**
+ * @enum Projection
+ * @brief Camera projection model
+ */
+enum class Projection
+{
+    Orthographic, ///< Parallel rays over a width x height image plane
+    Perspective   ///< Rays through a pinhole at the camera origin
+};
+
+/**
+ * @enum DepthEncoding
+ * @brief Mapping from normalized depth d to camera depth z
+ */
+enum class DepthEncoding
+{
+    Linear,  ///< z = near + d * (far - near)
+    ReverseZ ///< d = 1 at near and 0 at far; hyperbolic in z for perspective views
+};
+
+/**
+ * @struct CameraView
+ * @brief One view of a rig
+ */
+struct CameraView
+{
+    std::string name;                 ///< View name, e.g. "nx"
+    std::string filePattern;          ///< Image file name with a printf-style frame field, e.g. "%04dnx.png"
+    Projection projection = Projection::Orthographic;
+    DepthEncoding depthEncoding = DepthEncoding::Linear;
+    double width = 1.0;               ///< Orthographic image plane width in world units
+    double height = 1.0;              ///< Orthographic image plane height in world units
+    double fovY = 60.0;               ///< Perspective vertical field of view in degrees
+    double nearPlane = 0.0;           ///< Near end of the depth range
+    double farPlane = 1.0;            ///< Far end of the depth range
+    openvdb::Mat4d cameraToWorld = openvdb::Mat4d::identity(); ///< Row-vector convention, as openvdb::Mat4d
+
+    // Precompiled by compileRig
+    openvdb::Mat4d cameraToIndex = openvdb::Mat4d::identity(); ///< Camera space to grid index space
+    openvdb::Mat4d indexToCamera = openvdb::Mat4d::identity(); ///< Grid index space to camera space
+    double voxelsPerDepthUnit = 1.0;  ///< Grid voxels per unit of camera depth
+};
+
+/**
+ * @struct CameraRig
+ * @brief Set of views and the mapping from world space to grid index space
+ */
+struct CameraRig
+{
+    double voxelSize = 1.0;                    ///< World units per voxel
+    openvdb::Vec3d origin = openvdb::Vec3d(0); ///< World position of voxel (0, 0, 0)
+    std::vector<CameraView> views;
+};
+
+/**
+ * @struct PixelRow
+ * @brief Origin and ray direction of pixel column 0 of one image row
+ */
+struct PixelRow
+{
+    openvdb::Vec3d origin;
+    openvdb::Vec3d direction;
+};
+
+/**
+ * @struct PixelUnprojector
+ * @brief Pixel-to-grid mapping of a view at a given image size
+ *
+ * A sample at (col, row) with camera depth z lands at
+ * origin + col * colStep + z * (direction + col * colDirStep) in index space,
+ * with the row's origin and direction computed once per row. Orthographic
+ * views have constant directions (colDirStep = 0) and perspective views a
+ * single origin (colStep = 0), so unprojection costs one multiply-add per
+ * axis and term either way.
+ */
+struct PixelUnprojector
+{
+    openvdb::Vec3d base;       ///< Origin of pixel (0, 0)
+    openvdb::Vec3d colStep;    ///< Origin step per column
+    openvdb::Vec3d rowStep;    ///< Origin step per row
+    openvdb::Vec3d direction;  ///< Ray direction of pixel (0, 0), per unit of camera depth
+    openvdb::Vec3d colDirStep; ///< Direction step per column
+    openvdb::Vec3d rowDirStep; ///< Direction step per row
+
+    PixelRow row(int index) const
+    {
+        const double r = static_cast<double>(index);
+        return {base + rowStep * r, direction + rowDirStep * r};
+    }
+
+    openvdb::Vec3d unproject(const PixelRow &pixelRow, int col, double depth) const
+    {
+        const double c = static_cast<double>(col);
+        return pixelRow.origin + colStep * c + (pixelRow.direction + colDirStep * c) * depth;
+    }
+};
+
+/**
+ * @brief Builds the six-view orthographic cube rig covering the textureSize^3 domain
+ *
+ * Views are nx, ny, nz, px, py, pz, read from "<frame>nx.png" etc., with
+ * their depth range spanning the whole domain.
+ */
+CameraRig cubeRig(int textureSize);
+
+/**
+ * @brief Loads a rig description from a JSON file and compiles it
+ *
+ * The file holds optional "voxelSize" and "origin" entries and a "views"
+ * array. Each view has "name", "file", "projection" ("orthographic" or
+ * "perspective"), "depthEncoding" ("linear" or "reverse-z"), "near", "far"
+ * and "cameraToWorld", a 4x4 matrix of 16 numbers in row-major order with
+ * column vectors (translation in the last column). Orthographic views also
+ * have "width" and "height", perspective views a vertical "fov" in degrees.
+ *
+ * @param path Path to the rig file
+ * @param rig Loaded rig
+ * @return true on success
+ */
+bool loadRig(const std::string &path, CameraRig &rig);
+
+/**
+ * @brief Precomputes the per-view camera/grid transforms of a rig
+ */
+void compileRig(CameraRig &rig);
+
+/**
+ * @brief Replaces %d, %Nd and %0Nd in a pattern with a frame number and %% with a percent sign
+ */
+std::string expandFramePattern(const std::string &pattern, int frame);
+
+/**
+ * @brief Builds the image file path of a view for a frame
+ */
+std::string viewFilename(const CameraView &camera, const std::string &baseDir, int frame);
+
+/**
+ * @brief Recovers the frame number from a file name produced by a view's pattern
+ *
+ * The frame field matches one or more digits.
+ *
+ * @param camera View whose file pattern is matched
+ * @param filename File name relative to the base directory
+ * @param frame Parsed frame number
+ * @return true if the file name matches the pattern
+ */
+bool matchViewFilename(const CameraView &camera, const std::string &filename, int &frame);
+
+/**
+ * @brief Camera depth of a normalized depth value
+ */
+inline double cameraDepth(const CameraView &camera, float depth)
+{
+    const double range = camera.farPlane - camera.nearPlane;
+
+    if (camera.depthEncoding == DepthEncoding::Linear)
+    {
+        return camera.nearPlane + depth * range;
+    }
+    if (camera.projection == Projection::Perspective)
+    {
+        return camera.nearPlane * camera.farPlane / (camera.nearPlane + depth * range);
+    }
+    return camera.farPlane - depth * range;
+}
+
+/**
+ * @brief Precomputes the pixel-to-grid mapping of a view for an image size
+ */
+PixelUnprojector makeUnprojector(const CameraView &camera, int imageWidth, int imageHeight);
+
+/**
+ * @brief Projects a grid index space position into a view
+ * @param camera View to project into
+ * @param xyz Position in grid index space
+ * @param imageWidth Image width in pixels
+ * @param imageHeight Image height in pixels
+ * @param col Nearest pixel column
+ * @param row Nearest pixel row
+ * @param depth Camera depth of the position
+ * @return false if the position falls outside the image or behind a perspective camera
+ */
+bool projectToPixel(const CameraView &camera, const openvdb::Vec3d &xyz,
+                    int imageWidth, int imageHeight, int &col, int &row, double &depth);
@@ -0,0 +1,30 @@
+/**
+ * @file server.h
+ * @brief Conversion server accepting jobs over a Unix domain socket
+ *
+ * A job starts with the absolute working directory of the client on its
+ * own line, followed by the command line options of one conversion, one
+ * argument per line and ended by an empty line. Relative paths in the
+ * options are resolved against the client's directory, as if the client had
+ * run the conversion itself. The server answers with lines of its own:
+ *   - "frame N" once frame N has been written
+ *   - "message TEXT" for errors and the --help text
+ *   - "ok" or "failed" as the last line
+ * Closing the connection cancels the job after the frames in flight.
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Serves conversion jobs until the process is terminated
+ *
+ * Jobs run concurrently up to maxJobs and are started in arrival order. All
+ * of them share the process's TBB worker threads.
+ *
+ * @param socketPath Path of the socket, replaced if it already exists
+ * @param maxJobs Number of jobs run at once
+ * @return false if the socket cannot be set up
+ */
+bool runServer(const std::string &socketPath, int maxJobs);
@@ -0,0 +1,88 @@
+/**
+ * @file shm.h
+ * @brief Exchange of view buffers and VDB frames through POSIX shared memory
+ *
+ * Both layouts use native byte order.
+ *
+ * Views of a frame: a SharedViewsHeader, then for every rig view in order a
+ * SharedViewHeader followed by width * height RGBA pixels of four uint16_t
+ * channels, alpha storing one minus the normalized depth as in the images.
+ *
+ * Output of a frame: a SharedGridsHeader followed by the VDB file bytes.
+ * The magic is written last, after a release fence; until then it reads as
+ * zeros. A consumer polling the object waits for the magic, issues an
+ * acquire fence, then reads the size and the VDB bytes.
+ */
+
+#pragma once
+
+#include "views.h"
+
+#include <openvdb/openvdb.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr uint32_t sharedFormatVersion = 1;
+
+/**
+ * @struct SharedViewsHeader
+ * @brief Start of a shared-memory frame of views, magic "MVVW"
+ */
+struct SharedViewsHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t viewCount;
+    uint32_t reserved;
+};
+
+/**
+ * @struct SharedViewHeader
+ * @brief Size of the view whose pixels follow
+ */
+struct SharedViewHeader
+{
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * @struct SharedGridsHeader
+ * @brief Start of a shared-memory VDB frame, magic "MVDB"
+ */
+struct SharedGridsHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t size; ///< Number of VDB bytes that follow
+};
+
+/**
+ * @brief Decodes the views of a frame from a shared memory object
+ *
+ * The object is left in place for the producer to reuse.
+ *
+ * @param name Shared memory object name, such as /multiview_0001
+ * @param window Depth window, or the fallback clip planes in adaptive mode
+ * @param adaptive Pick the clip planes from each view's depth histogram
+ * @param views Decoded views, one per rig view; their count must match the object's
+ * @param verbose Enable verbose logging
+ * @return false if the object is missing or malformed
+ */
+bool loadSharedViews(const std::string &name, const DepthWindow &window, bool adaptive,
+                     std::vector<DepthView> &views, bool verbose);
+
+/**
+ * @brief Serializes grids into a shared memory object, replacing its contents
+ *
+ * The object is complete once the function returns, or once its magic
+ * reads "MVDB" for a consumer that maps it earlier; the consumer unlinks it.
+ *
+ * @param name Shared memory object name
+ * @param grids Grids of the frame
+ * @param stableHeader Derive the archive UUID from the grids instead of drawing a random one
+ * @param verbose Enable verbose logging
+ * @return false if the object cannot be written
+ */
+bool writeSharedGrids(const std::string &name, const openvdb::GridPtrVec &grids, bool stableHeader, bool verbose);
@@ -0,0 +1,48 @@
+/**
+ * @file splat.h
+ * @brief Sub-voxel splatting of view samples into the color and alpha grids
+ */
+
+#pragma once
+
+#include "views.h"
+#include "determinism.h"
+
+#include <openvdb/openvdb.h>
+#include <vector>
+
+/**
+ * @enum SplatKernel
+ * @brief Footprint used to distribute a sample over neighboring voxels
+ */
+enum class SplatKernel
+{
+    Nearest,   ///< Whole sample in the closest voxel
+    Trilinear, ///< Trilinear weights over the 2x2x2 surrounding voxels
+    Gaussian   ///< Normalized Gaussian over a (2 * radius + 1)^3 neighborhood
+};
+
+/**
+ * @brief Splats samples at their unquantized positions into the grids
+ *
+ * Every sample spreads its alpha over the kernel footprint; colors are the
+ * alpha-weighted average of all contributions to a voxel, as in
+ * combineVoxels. Samples are sorted by leaf node so that consecutive writes
+ * land in the same leaf, weights are computed in batches, and batches are
+ * accumulated in parallel into thread-local grids.
+ *
+ * @param voxelDataList Samples with positions scaled to textureSize
+ * @param textureSize Size of the grid domain
+ * @param kernel Splatting footprint
+ * @param radius Neighborhood radius in voxels for the Gaussian kernel
+ * @param rgbGrid Output color grid
+ * @param alphaGrid Output alpha grid (accumulated sample weights)
+ * @param summation Order and compensation of the parallel sums
+ */
+void splatVoxels(const std::vector<VoxelData> &voxelDataList,
+                 int textureSize,
+                 SplatKernel kernel,
+                 int radius,
+                 openvdb::Vec3fGrid::Ptr rgbGrid,
+                 openvdb::FloatGrid::Ptr alphaGrid,
+                 const SummationOptions &summation);
@@ -0,0 +1,85 @@
+/**
+ * @file stream.h
+ * @brief Framed view input on stdin and length-prefixed VDB output on stdout
+ *
+ * Both streams use native byte order.
+ *
+ * Input, per frame: a StreamFrameHeader, then for every rig view in order a
+ * uint64_t byte count followed by an image file of that many bytes (PNG or
+ * any other format the view images may use). The stream ends at end of file.
+ *
+ * Output, per frame: a StreamGridsHeader followed by the VDB file bytes.
+ */
+
+#pragma once
+
+#include <openvdb/openvdb.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct StreamFrameHeader
+ * @brief Start of a frame of view images, magic "MVFR"
+ */
+struct StreamFrameHeader
+{
+    char magic[4];
+    uint32_t frame;
+    uint32_t viewCount;
+    uint32_t reserved;
+};
+
+/**
+ * @struct StreamGridsHeader
+ * @brief Start of a VDB frame, magic "MVDB"
+ */
+struct StreamGridsHeader
+{
+    char magic[4];
+    uint32_t frame;
+    uint64_t size; ///< Number of VDB bytes that follow
+};
+
+/**
+ * @enum StreamRead
+ * @brief Outcome of reading a frame record from standard input
+ */
+enum class StreamRead
+{
+    Frame, ///< A whole record was read
+    End,   ///< The stream ended cleanly between records
+    Error  ///< The record is malformed or truncated
+};
+
+/**
+ * @brief Reads the next frame of view images from standard input
+ * @param viewCount Number of views of the rig
+ * @param frame Frame number of the record
+ * @param images Encoded image of each view; the buffers are reused
+ * @return End only when the stream ends before a record starts
+ */
+StreamRead readStreamFrame(size_t viewCount, int &frame, std::vector<std::vector<unsigned char>> &images);
+
+/**
+ * @brief Reserves standard output for VDB frames
+ *
+ * Log output written to stdout afterwards goes to stderr, so it cannot
+ * corrupt the stream. Call before any frame is converted.
+ *
+ * @return false if the descriptors cannot be redirected
+ */
+bool claimStandardOutput();
+
+/**
+ * @brief Writes a frame's grids to the claimed standard output
+ *
+ * Frames may be written from several threads; each record is written whole,
+ * in completion order.
+ *
+ * @param frame Frame number
+ * @param grids Grids of the frame
+ * @param stableHeader Derive the archive UUID from the grids instead of drawing a random one
+ * @param verbose Enable verbose logging
+ * @return false if the stream cannot be written
+ */
+bool writeStreamGrids(int frame, const openvdb::GridPtrVec &grids, bool stableHeader, bool verbose);
@@ -0,0 +1,38 @@
+/**
+ * @file tsdf.h
+ * @brief Truncated signed distance fusion of the depth views
+ */
+
+#pragma once
+
+#include "views.h"
+#include "determinism.h"
+
+#include <openvdb/openvdb.h>
+#include <vector>
+
+/**
+ * @brief Fuses the depth views into a narrow-band signed distance level set
+ *
+ * Every view ray writes signed distances to its surface (positive in front,
+ * negative behind) for the voxels within the truncation band around the
+ * surface. Samples from all views are averaged with equal weights, so only
+ * band voxels are ever touched and the cost scales with surface area. Rays
+ * are processed in parallel into thread-local accumulation grids.
+ *
+ * @param views Decoded views, one per rig camera; empty views are ignored
+ * @param rig Camera rig the views were rendered from
+ * @param textureSize Size of the texture (assumed square)
+ * @param truncation Half width of the truncation band in voxels
+ * @param rgbGrid Output color grid, averaged over the band voxels
+ * @param summation Order and compensation of the parallel sums
+ * @param verbose Enable verbose logging
+ * @return Level set grid whose background is the truncation distance
+ */
+openvdb::FloatGrid::Ptr fuseTsdf(const std::vector<DepthView> &views,
+                                 const CameraRig &rig,
+                                 int textureSize,
+                                 float truncation,
+                                 openvdb::Vec3fGrid::Ptr rgbGrid,
+                                 const SummationOptions &summation,
+                                 bool verbose);
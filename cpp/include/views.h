@@ -0,0 +1,202 @@
+/**
+ * @file views.h
+ * @brief Decoding of view depth maps into grid samples
+ *
+ * Each view image stores color in RGB and depth in alpha (depth = 1 - alpha).
+ * Pixels are addressed as (y, z) with y the column and z the row. The
+ * mapping from pixels to grid coordinates is given by the view's camera.
+ */
+
+#pragma once
+
+#include "rig.h"
+
+#include <openvdb/openvdb.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Depth values closer than this to either end of the range are background by default
+ */
+constexpr float defaultDepthThreshold = 0.05f;
+
+/**
+ * @struct DepthWindow
+ * @brief Range of normalized depths treated as geometry; anything outside is background
+ */
+struct DepthWindow
+{
+    float nearClip = defaultDepthThreshold;        ///< Depths below this are background
+    float farClip = 1.0f - defaultDepthThreshold;  ///< Depths above this are background
+
+    bool contains(float depth) const { return depth >= nearClip && depth <= farClip; }
+};
+
+/**
+ * @brief Edge length in pixels of the tiles used to skip background regions
+ */
+constexpr int depthTileSize = 16;
+
+/**
+ * @struct VoxelData
+ * @brief Represents a single voxel's position and color data
+ */
+struct VoxelData
+{
+    int x, y, z;             ///< Grid coordinates
+    openvdb::Vec3s position; ///< Unquantized grid position
+    openvdb::Vec3f color;    ///< RGB color values
+    float alpha;             ///< Alpha/transparency value
+};
+
+/**
+ * @struct DepthView
+ * @brief Decoded depth map of a single view
+ */
+struct DepthView
+{
+    int width = 0;                     ///< Image width in pixels
+    int height = 0;                    ///< Image height in pixels
+    std::vector<float> depth;          ///< Normalized depth per pixel, row-major
+    std::vector<openvdb::Vec3f> color; ///< RGB color per pixel, row-major
+    DepthWindow window;                ///< Depth window used to separate geometry from background
+    int tilesX = 0;                    ///< Number of depthTileSize tiles per row
+    int tilesY = 0;                    ///< Number of depthTileSize tiles per column
+    std::vector<float> tileMinDepth;   ///< Smallest depth per tile, row-major
+    std::vector<float> tileMaxDepth;   ///< Largest depth per tile, row-major
+
+    bool empty() const { return depth.empty(); }
+
+    /**
+     * @brief Bytes reserved by the view's buffers
+     */
+    size_t memUsage() const
+    {
+        return depth.capacity() * sizeof(float) + color.capacity() * sizeof(openvdb::Vec3f) +
+               (tileMinDepth.capacity() + tileMaxDepth.capacity()) * sizeof(float);
+    }
+
+    /**
+     * @brief Checks whether a normalized depth value lies outside the view's depth window
+     */
+    bool isBackground(float value) const { return !window.contains(value); }
+
+    /**
+     * @brief Checks whether a whole tile lies on one side of the depth window
+     */
+    bool isBackgroundTile(int tileX, int tileY) const
+    {
+        const size_t tile = static_cast<size_t>(tileY) * tilesX + tileX;
+        return tileMaxDepth[tile] < window.nearClip || tileMinDepth[tile] > window.farClip;
+    }
+};
+
+/**
+ * @struct TileBounds
+ * @brief Pixel bounds of the tiles of a view that may hold geometry
+ */
+struct TileBounds
+{
+    int minCol = 0;
+    int minRow = 0;
+    int maxCol = -1;
+    int maxRow = -1;
+    size_t pixelCount = 0; ///< Number of pixels in those tiles
+
+    bool empty() const { return pixelCount == 0; }
+};
+
+/**
+ * @brief Loads a view image and decodes its depth and color channels
+ *
+ * The depth range of every depthTileSize x depthTileSize tile is gathered
+ * while decoding, so background tiles can be skipped without visiting their
+ * pixels. In adaptive mode a histogram of the 8-bit depths is gathered in the
+ * same pass. Background usually forms a spike at one end of the range separated
+ * from the geometry by empty bins; each clip plane is placed in the middle of
+ * such a gap. Ends without a clear gap keep the plane from the given window.
+ *
+ * @param filename Path to the image file
+ * @param window Depth window, or the fallback clip planes in adaptive mode
+ * @param adaptive Pick the clip planes from the view's depth histogram
+ * @param view Decoded view; left empty if the image cannot be loaded
+ * @param verbose Enable verbose logging
+ * @return true if the image was loaded
+ */
+bool loadDepthView(const std::string &filename, const DepthWindow &window, bool adaptive,
+                   DepthView &view, bool verbose);
+
+/**
+ * @brief Reads the encoded image of a view without decoding it
+ *
+ * Lets callers limit concurrent file reads separately from decoding.
+ *
+ * @param filename Path to the image file
+ * @param data File contents; the buffer is reused
+ * @return false if the file cannot be read
+ */
+bool readViewFile(const std::string &filename, std::vector<unsigned char> &data);
+
+/**
+ * @brief Decodes a view from image file bytes already in memory
+ * @param data Encoded image, in any format loadDepthView accepts
+ * @param size Number of bytes
+ * @param window Depth window, or the fallback clip planes in adaptive mode
+ * @param adaptive Pick the clip planes from the view's depth histogram
+ * @param view Decoded view; left empty if the image cannot be decoded
+ * @param verbose Enable verbose logging
+ * @return true if the image was decoded
+ */
+bool loadDepthView(const unsigned char *data, size_t size, const DepthWindow &window, bool adaptive,
+                   DepthView &view, bool verbose);
+
+/**
+ * @brief Decodes a view from 16-bit RGBA pixels already in memory
+ *
+ * Pixels use the layout of the view images: row-major RGBA, with alpha
+ * storing one minus the normalized depth. Tiles and the adaptive window are
+ * computed as in loadDepthView.
+ *
+ * @param pixels width * height * 4 channel values
+ * @param width Image width
+ * @param height Image height
+ * @param window Depth window, or the fallback clip planes in adaptive mode
+ * @param adaptive Pick the clip planes from the view's depth histogram
+ * @param view Decoded view
+ * @param verbose Enable verbose logging
+ */
+void decodeDepthView(const uint16_t *pixels, int width, int height, const DepthWindow &window,
+                     bool adaptive, DepthView &view, bool verbose);
+
+/**
+ * @brief Bounds the pixels of a view that are not in background tiles
+ *
+ * The pixel count is an upper bound on the number of samples the view
+ * produces, so callers can size their buffers before decoding.
+ */
+TileBounds candidateBounds(const DepthView &view);
+
+/**
+ * @brief Computes the surface depth of every pixel of a view in grid voxels
+ *
+ * Depths are camera depths scaled by the camera's voxelsPerDepthUnit, so
+ * they compare directly with the depth of a reprojected voxel.
+ *
+ * @param view Decoded view
+ * @param camera Camera the view was rendered from
+ * @return Row-major depths, +infinity for background pixels
+ */
+std::vector<float> surfaceDepths(const DepthView &view, const CameraView &camera);
+
+/**
+ * @brief Maps the first-surface samples of a view to grid index coordinates
+ * @param view Decoded view
+ * @param camera Camera the view was rendered from
+ * @param voxelDataList Vector to store the processed voxel data
+ * @param verbose Enable verbose logging
+ */
+void processView(const DepthView &view,
+                 const CameraView &camera,
+                 std::vector<VoxelData> &voxelDataList,
+                 bool verbose);
@@ -0,0 +1,73 @@
+/**
+ * @file watch.h
+ * @brief Watch-folder ingestion: reports frames once all their views are written
+ */
+
+#pragma once
+
+#include "rig.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @class FrameWatcher
+ * @brief Monitors the input directory with inotify for completed frames
+ *
+ * A frame is ready once the image of every rig view exists and none of them
+ * has been written to for the settle time. Files already present when
+ * watching starts count as written at that moment. Only frames within
+ * [startFrame, endFrame] are reported, each once, in the order they become
+ * ready.
+ */
+class FrameWatcher
+{
+public:
+    FrameWatcher(const std::string &baseDir, const CameraRig &rig,
+                 int startFrame, int endFrame, int settleMilliseconds);
+    ~FrameWatcher();
+
+    FrameWatcher(const FrameWatcher &) = delete;
+    FrameWatcher &operator=(const FrameWatcher &) = delete;
+
+    /**
+     * @brief Starts watching and scans the files already present
+     * @return false if the directory cannot be watched
+     */
+    bool start();
+
+    /**
+     * @brief Blocks until a frame is ready or the wait is cancelled
+     * @param frame Ready frame number
+     * @param cancelled Checked at least every cancelCheckMilliseconds while waiting; true ends the wait
+     * @return false once every frame of the range has been reported, when cancelled, or on error
+     */
+    bool nextFrame(int &frame, const std::function<bool()> &cancelled);
+
+    static constexpr int cancelCheckMilliseconds = 200;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingFrame
+    {
+        std::vector<bool> present;
+        Clock::time_point lastWrite;
+        bool reported = false;
+    };
+
+    void fileWritten(const std::string &filename);
+    bool readEvents(int timeoutMilliseconds);
+
+    std::string mBaseDir;
+    const CameraRig &mRig;
+    int mStartFrame;
+    int mEndFrame;
+    std::chrono::milliseconds mSettle;
+    int mFd = -1;
+    std::map<int, PendingFrame> mPending;
+    int mReported = 0;
+};
@@ -0,0 +1,146 @@
+/**
+ * @file arena.cpp
+ * @brief Bump allocator for per-frame transient buffers, reset between frames
+ */
+
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+
+constexpr size_t arenaAlignment = alignof(std::max_align_t);
+
+thread_local FrameArena *boundArena = nullptr;
+
+size_t alignUp(size_t size)
+{
+    return (size + arenaAlignment - 1) & ~(arenaAlignment - 1);
+}
+
+} // namespace
+
+FrameArena::FrameArena(size_t blockSize)
+    : mBlockSize(blockSize)
+{
+}
+
+void *FrameArena::allocate(size_t size)
+{
+    size = alignUp(std::max<size_t>(size, 1));
+
+    if (mBlocks.empty() || mBlocks.back().offset + size > mBlocks.back().size)
+    {
+        Block block;
+        block.size = std::max(mBlockSize, size);
+        block.data.reset(new unsigned char[block.size]);
+        block.offset = 0;
+        mBlocks.push_back(std::move(block));
+    }
+
+    Block &block = mBlocks.back();
+    mLast = block.data.get() + block.offset;
+    block.offset += size;
+    return mLast;
+}
+
+void *FrameArena::reallocate(void *pointer, size_t oldSize, size_t newSize)
+{
+    if (pointer == nullptr)
+    {
+        return allocate(newSize);
+    }
+
+    // The most recent allocation can grow into the rest of its block
+    if (pointer == mLast)
+    {
+        Block &block = mBlocks.back();
+        const size_t start = static_cast<size_t>(mLast - block.data.get());
+        if (start + alignUp(newSize) <= block.size)
+        {
+            block.offset = start + alignUp(std::max<size_t>(newSize, 1));
+            return pointer;
+        }
+    }
+
+    void *result = allocate(newSize);
+    std::memcpy(result, pointer, std::min(oldSize, newSize));
+    return result;
+}
+
+bool FrameArena::owns(const void *pointer) const
+{
+    const unsigned char *p = static_cast<const unsigned char *>(pointer);
+
+    for (const auto &block : mBlocks)
+    {
+        if (p >= block.data.get() && p < block.data.get() + block.size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameArena::reset()
+{
+    // Replace several blocks by one large enough for all of them
+    if (mBlocks.size() > 1)
+    {
+        mBlockSize = std::max(mBlockSize, capacity());
+        mBlocks.clear();
+    }
+
+    for (auto &block : mBlocks)
+    {
+        block.offset = 0;
+    }
+    mLast = nullptr;
+}
+
+size_t FrameArena::capacity() const
+{
+    size_t total = 0;
+    for (const auto &block : mBlocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+ArenaScope::ArenaScope(FrameArena &arena)
+    : mPrevious(boundArena)
+{
+    boundArena = &arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    boundArena = mPrevious;
+}
+
+void *arenaMalloc(size_t size)
+{
+    return boundArena ? boundArena->allocate(size) : std::malloc(size);
+}
+
+void *arenaRealloc(void *pointer, size_t oldSize, size_t newSize)
+{
+    if (boundArena && (pointer == nullptr || boundArena->owns(pointer)))
+    {
+        return boundArena->reallocate(pointer, oldSize, newSize);
+    }
+    return std::realloc(pointer, newSize);
+}
+
+void arenaFree(void *pointer)
+{
+    if (boundArena && boundArena->owns(pointer))
+    {
+        return;
+    }
+    std::free(pointer);
+}
@@ -0,0 +1,213 @@
+/**
+ * @file batch.cpp
+ * @brief Conversion of many shots listed in a manifest on one frame pipeline
+ */
+
+#include "batch.h"
+#include "convert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @struct BatchShot
+ * @brief One manifest line with its progress and statistics
+ */
+struct BatchShot
+{
+    int line = 0;
+    ProgramOptions options;
+    CameraRig rig;
+    bool ready = false;
+    int nextFrame = 0;
+
+    int frames = 0;
+    int failedFrames = 0;
+    double frameSeconds = 0.0; ///< Sum of the frames' conversion times
+    size_t peakFrameBytes = 0;
+    Clock::time_point firstStart;
+    Clock::time_point lastFinish;
+};
+
+/**
+ * @brief Parses the manifest lines into shots, each extending the command line
+ */
+bool loadManifest(const ProgramOptions &options, int argc, const char *const argv[],
+                  std::vector<BatchShot> &shots)
+{
+    std::ifstream manifest(options.batchManifest);
+    if (!manifest)
+    {
+        std::cerr << "Error: Could not open batch manifest: " << options.batchManifest << std::endl;
+        return false;
+    }
+
+    // Command line arguments without the --batch option itself
+    std::vector<std::string> common;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            i++;
+            continue;
+        }
+        common.push_back(argv[i]);
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(manifest, line))
+    {
+        lineNumber++;
+
+        std::istringstream tokens(line);
+        std::vector<std::string> args{argv[0]};
+        args.insert(args.end(), common.begin(), common.end());
+        const size_t commonCount = args.size();
+
+        std::string token;
+        while (tokens >> token)
+        {
+            args.push_back(token);
+        }
+        if (args.size() == commonCount || args[commonCount][0] == '#')
+        {
+            continue;
+        }
+
+        std::vector<const char *> shotArgv;
+        for (const auto &arg : args)
+        {
+            shotArgv.push_back(arg.c_str());
+        }
+
+        BatchShot shot;
+        shot.line = lineNumber;
+        if (!parseOptions(static_cast<int>(shotArgv.size()), shotArgv.data(), shot.options, std::cerr))
+        {
+            std::cerr << "Error: Invalid options on line " << lineNumber << " of " << options.batchManifest << std::endl;
+            return false;
+        }
+
+        if (shot.options.watch || shot.options.streamInput || shot.options.streamOutput ||
+            !shot.options.serverSocket.empty() || !shot.options.batchManifest.empty())
+        {
+            std::cerr << "Error: --watch, --stdin, --stdout, --server and --batch are not allowed on line "
+                      << lineNumber << " of " << options.batchManifest << std::endl;
+            return false;
+        }
+
+        shots.push_back(std::move(shot));
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool runBatch(const ProgramOptions &options, int argc, const char *const argv[])
+{
+    std::vector<BatchShot> shots;
+    if (!loadManifest(options, argc, argv, shots))
+    {
+        return false;
+    }
+
+    // A shot that cannot start is reported and the others still run
+    for (auto &shot : shots)
+    {
+        shot.ready = setupConversion(shot.options, shot.rig, std::cerr);
+        shot.nextFrame = shot.options.startFrame;
+    }
+
+    // Frames of all shots run through the same stages, started round-robin across the shots
+    size_t cursor = 0;
+
+    runFramePipeline(
+        options,
+        [&](FrameRequest &request)
+        {
+            for (size_t tried = 0; tried < shots.size(); tried++)
+            {
+                const size_t index = (cursor + tried) % shots.size();
+                BatchShot &shot = shots[index];
+                if (shot.ready && shot.nextFrame <= shot.options.endFrame)
+                {
+                    request.options = &shot.options;
+                    request.rig = &shot.rig;
+                    request.source = index;
+                    request.frame = shot.nextFrame++;
+                    cursor = index + 1;
+                    return true;
+                }
+            }
+            return false;
+        },
+        [&](const FrameResult &result)
+        {
+            BatchShot &shot = shots[result.source];
+            if (result.failed)
+            {
+                std::cerr << "Error: Frame " << result.frame << " of " << shot.options.baseDir
+                          << " failed: " << result.error << std::endl;
+            }
+
+            if (shot.frames + shot.failedFrames == 0)
+            {
+                shot.firstStart = result.start;
+            }
+            shot.firstStart = std::min(shot.firstStart, result.start);
+            shot.lastFinish = std::max(shot.lastFinish, result.finish);
+            shot.frameSeconds += std::chrono::duration<double>(result.finish - result.start).count();
+            shot.peakFrameBytes = std::max(shot.peakFrameBytes, result.frameBytes);
+            (result.failed ? shot.failedFrames : shot.frames)++;
+
+            if (options.verbose)
+            {
+                std::cout << "Shot " << shot.options.baseDir << ": frame " << result.frame
+                          << (result.failed ? " failed" : " done") << std::endl;
+            }
+            return true;
+        });
+
+    // Per-shot summary
+    bool succeeded = true;
+    std::cout << "Batch summary:" << std::endl << std::fixed << std::setprecision(2);
+
+    for (const auto &shot : shots)
+    {
+        std::cout << "  line " << shot.line << ", " << shot.options.baseDir << ": ";
+
+        if (!shot.ready)
+        {
+            std::cout << "skipped" << std::endl;
+            succeeded = false;
+            continue;
+        }
+
+        const int attempted = shot.frames + shot.failedFrames;
+        const double wallSeconds = attempted > 0
+                                       ? std::chrono::duration<double>(shot.lastFinish - shot.firstStart).count()
+                                       : 0.0;
+        std::cout << shot.frames << " frames, " << shot.failedFrames << " failed, "
+                  << wallSeconds << " s wall, "
+                  << (attempted > 0 ? shot.frameSeconds / attempted : 0.0) << " s/frame, "
+                  << "peak frame " << std::setprecision(1) << toMegabytes(shot.peakFrameBytes) << " MB"
+                  << std::setprecision(2) << std::endl;
+
+        succeeded = succeeded && shot.failedFrames == 0;
+    }
+
+    return succeeded;
+}
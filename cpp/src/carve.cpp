@@ -0,0 +1,173 @@
+/**
+ * @file carve.cpp
+ * @brief Space-carving reconstruction of a solid volume from the depth views
+ */
+
+#include "carve.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+
+/**
+ * @struct CarveView
+ * @brief Per-pixel occupancy intervals of one view
+ */
+struct CarveView
+{
+    const CameraView *camera;
+    const DepthView *view;
+    std::vector<float> surface; ///< Depth in voxels where the interval starts, +inf for empty
+};
+
+/**
+ * @struct CarveSlabs
+ * @brief tbb::parallel_reduce body carving z-slabs into thread-local grids
+ *
+ * Each slab is one leaf deep, so thread-local trees never share leaves.
+ */
+struct CarveSlabs
+{
+    const std::vector<CarveView> &views;
+    int textureSize;
+    openvdb::Vec3fGrid::Ptr rgbGrid;
+    openvdb::FloatGrid::Ptr alphaGrid;
+
+    CarveSlabs(const std::vector<CarveView> &views, int textureSize)
+        : views(views), textureSize(textureSize),
+          rgbGrid(openvdb::Vec3fGrid::create()), alphaGrid(openvdb::FloatGrid::create())
+    {
+    }
+
+    CarveSlabs(CarveSlabs &other, tbb::split)
+        : CarveSlabs(other.views, other.textureSize)
+    {
+    }
+
+    void operator()(const tbb::blocked_range<int> &slabs)
+    {
+        auto rgbAccessor = rgbGrid->getAccessor();
+        auto alphaAccessor = alphaGrid->getAccessor();
+
+        const int slabDepth = openvdb::FloatTree::LeafNodeType::DIM;
+        const int zBegin = slabs.begin() * slabDepth;
+        const int zEnd = std::min(slabs.end() * slabDepth, textureSize);
+
+        for (int vz = zBegin; vz < zEnd; vz++)
+        {
+            for (int vy = 0; vy < textureSize; vy++)
+            {
+                for (int vx = 0; vx < textureSize; vx++)
+                {
+                    openvdb::Coord ijk(vx, vy, vz);
+                    openvdb::Vec3f color(0.0f);
+                    float closest = std::numeric_limits<float>::max();
+                    bool inside = true;
+
+                    for (const auto &carveView : views)
+                    {
+                        const DepthView &view = *carveView.view;
+                        int y, z;
+                        double depth;
+                        if (!projectToPixel(*carveView.camera, ijk.asVec3d(), view.width, view.height, y, z, depth))
+                        {
+                            inside = false;
+                            break;
+                        }
+
+                        // Half a voxel of slack so voxels on the quantized surface count as inside
+                        const size_t pixel = static_cast<size_t>(z) * view.width + y;
+                        const float offset = static_cast<float>(depth * carveView.camera->voxelsPerDepthUnit) -
+                                             carveView.surface[pixel];
+                        if (offset < -0.5f)
+                        {
+                            inside = false;
+                            break;
+                        }
+
+                        if (offset < closest)
+                        {
+                            closest = offset;
+                            color = view.color[pixel];
+                        }
+                    }
+
+                    if (inside)
+                    {
+                        rgbAccessor.setValue(ijk, color);
+                        alphaAccessor.setValue(ijk, 1.0f);
+                    }
+                }
+            }
+        }
+    }
+
+    void join(CarveSlabs &other)
+    {
+        rgbGrid->tree().merge(other.rgbGrid->tree());
+        alphaGrid->tree().merge(other.alphaGrid->tree());
+    }
+};
+
+} // namespace
+
+void carveVolume(const std::vector<DepthView> &views,
+                 const CameraRig &rig,
+                 int textureSize,
+                 openvdb::Vec3fGrid::Ptr rgbGrid,
+                 openvdb::FloatGrid::Ptr alphaGrid,
+                 bool verbose)
+{
+    std::vector<CarveView> carveViews;
+
+    for (size_t viewIndex = 0; viewIndex < views.size(); viewIndex++)
+    {
+        const DepthView &view = views[viewIndex];
+        if (view.empty())
+        {
+            continue;
+        }
+
+        CarveView carveView;
+        carveView.camera = &rig.views[viewIndex];
+        carveView.view = &view;
+        carveView.surface = surfaceDepths(view, *carveView.camera);
+
+        // Surfaces are quantized to whole voxels along the view direction
+        for (float &surface : carveView.surface)
+        {
+            surface = std::round(surface);
+        }
+
+        carveViews.push_back(std::move(carveView));
+    }
+
+    if (carveViews.empty())
+    {
+        std::cerr << "Error: No views available for carving" << std::endl;
+        return;
+    }
+
+    // The range counts leaf-deep z-slabs, so every split falls on a leaf boundary
+    const int slabDepth = openvdb::FloatTree::LeafNodeType::DIM;
+    const int slabCount = (textureSize + slabDepth - 1) / slabDepth;
+
+    CarveSlabs carve(carveViews, textureSize);
+    tbb::parallel_reduce(tbb::blocked_range<int>(0, slabCount), carve);
+
+    rgbGrid->tree().merge(carve.rgbGrid->tree());
+    alphaGrid->tree().merge(carve.alphaGrid->tree());
+
+    if (verbose)
+    {
+        std::cout << "Carving complete: " << std::endl
+                  << "  - Views used: " << carveViews.size() << std::endl
+                  << "  - Inside voxels: " << alphaGrid->activeVoxelCount() << std::endl;
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file consistency.cpp
+ * @brief Multi-view consistency filtering of reconstructed surface voxels
+ */
+
+#include "consistency.h"
+
+#include <openvdb/tools/Prune.h>
+#include <openvdb/tree/LeafManager.h>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+/**
+ * @struct ConsistencyView
+ * @brief Surface depths of one view in grid voxels
+ */
+struct ConsistencyView
+{
+    const CameraView *camera;
+    const DepthView *view;
+    std::vector<float> surface;
+};
+
+} // namespace
+
+void filterConsistentVoxels(const std::vector<DepthView> &views,
+                            const CameraRig &rig,
+                            int minViews,
+                            float tolerance,
+                            openvdb::Vec3fGrid::Ptr rgbGrid,
+                            openvdb::FloatGrid::Ptr alphaGrid,
+                            bool verbose)
+{
+    std::vector<ConsistencyView> consistencyViews;
+
+    for (size_t viewIndex = 0; viewIndex < views.size(); viewIndex++)
+    {
+        if (views[viewIndex].empty())
+        {
+            continue;
+        }
+
+        ConsistencyView consistencyView;
+        consistencyView.camera = &rig.views[viewIndex];
+        consistencyView.view = &views[viewIndex];
+        consistencyView.surface = surfaceDepths(views[viewIndex], rig.views[viewIndex]);
+        consistencyViews.push_back(std::move(consistencyView));
+    }
+
+    const openvdb::Index64 voxelsBefore = alphaGrid->activeVoxelCount();
+
+    openvdb::tree::LeafManager<openvdb::FloatTree> leafManager(alphaGrid->tree());
+    openvdb::Vec3fTree &rgbTree = rgbGrid->tree();
+
+    // Rejected voxels take the background values, so they read like empty space
+    const float alphaBackground = alphaGrid->background();
+    const openvdb::Vec3f rgbBackground = rgbGrid->background();
+
+    leafManager.foreach(
+        [&](openvdb::FloatTree::LeafNodeType &leaf, size_t)
+        {
+            auto *rgbLeaf = rgbTree.probeLeaf(leaf.origin());
+
+            for (auto iter = leaf.beginValueOn(); iter; ++iter)
+            {
+                const openvdb::Vec3d xyz = iter.getCoord().asVec3d();
+                int agreeing = 0;
+
+                for (const auto &consistencyView : consistencyViews)
+                {
+                    const DepthView &view = *consistencyView.view;
+                    int col, row;
+                    double depth;
+                    if (!projectToPixel(*consistencyView.camera, xyz, view.width, view.height, col, row, depth))
+                    {
+                        continue;
+                    }
+
+                    const size_t pixel = static_cast<size_t>(row) * view.width + col;
+                    const float voxelDepth = static_cast<float>(depth * consistencyView.camera->voxelsPerDepthUnit);
+                    if (std::fabs(voxelDepth - consistencyView.surface[pixel]) <= tolerance)
+                    {
+                        agreeing++;
+                    }
+                }
+
+                if (agreeing < minViews)
+                {
+                    leaf.setValueOff(iter.pos(), alphaBackground);
+                    if (rgbLeaf)
+                    {
+                        rgbLeaf->setValueOff(iter.pos(), rgbBackground);
+                    }
+                }
+            }
+        });
+
+    // Drop the leaves that lost all their voxels
+    openvdb::tools::pruneInactive(alphaGrid->tree());
+    openvdb::tools::pruneInactive(rgbTree);
+
+    if (verbose)
+    {
+        std::cout << "Consistency filtering complete: " << std::endl
+                  << "  - Views used: " << consistencyViews.size() << std::endl
+                  << "  - Removed voxels: " << voxelsBefore - alphaGrid->activeVoxelCount() << std::endl;
+    }
+}
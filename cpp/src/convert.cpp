@@ -0,0 +1,763 @@
+/**
+ * @file convert.cpp
+ * @brief Per-frame reconstruction and the frame pipeline driving it
+ */
+
+#include "convert.h"
+#include "carve.h"
+#include "tsdf.h"
+#include "levelset.h"
+#include "mesh.h"
+#include "pointcloud.h"
+#include "splat.h"
+#include "lod.h"
+#include "consistency.h"
+#include "shm.h"
+#include "stream.h"
+#include "watch.h"
+#include "numa.h"
+#include "determinism.h"
+
+#include <openvdb/math/Transform.h>
+#include <openvdb/math/Mat4.h>
+#include <tbb/flow_graph.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <filesystem>
+#include <thread>
+
+void combineVoxels(openvdb::Vec3fGrid::Ptr rgbGrid, openvdb::FloatGrid::Ptr alphaGrid, const std::vector<VoxelData> &voxelDataList, int textureSize)
+{
+    using AlphaLeaf = openvdb::FloatTree::LeafNodeType;
+    using ColorLeaf = openvdb::Vec3fTree::LeafNodeType;
+
+    const openvdb::CoordBBox domain(openvdb::Coord(0), openvdb::Coord(textureSize - 1));
+
+    // Allocate the leaves of all samples up front, in coordinate order
+    std::vector<openvdb::Coord> origins;
+    origins.reserve(voxelDataList.size());
+    for (const auto &voxel : voxelDataList)
+    {
+        const openvdb::Coord coord(voxel.x, voxel.y, voxel.z);
+        if (domain.isInside(coord))
+        {
+            origins.push_back(coord & ~static_cast<openvdb::Int32>(AlphaLeaf::DIM - 1));
+        }
+    }
+    tbb::parallel_sort(origins.begin(), origins.end());
+    origins.erase(std::unique(origins.begin(), origins.end()), origins.end());
+
+    for (const auto &origin : origins)
+    {
+        alphaGrid->tree().touchLeaf(origin);
+        rgbGrid->tree().touchLeaf(origin);
+    }
+
+    // Every sample now lands in an existing leaf, so accumulation only touches leaf buffers
+    auto alphaAccessor = alphaGrid->getAccessor();
+    auto rgbAccessor = rgbGrid->getAccessor();
+
+    for (const auto &voxel : voxelDataList)
+    {
+        openvdb::Coord coord(voxel.x, voxel.y, voxel.z);
+        if (!domain.isInside(coord))
+        {
+            continue;
+        }
+
+        AlphaLeaf *alphaLeaf = alphaAccessor.probeLeaf(coord);
+        ColorLeaf *rgbLeaf = rgbAccessor.probeLeaf(coord);
+        const openvdb::Index offset = AlphaLeaf::coordToOffset(coord);
+
+        openvdb::Vec3f existingColor = rgbLeaf->getValue(offset);
+        float existingAlpha = alphaLeaf->getValue(offset);
+
+        if (existingAlpha == 0.0f)
+        {
+            rgbLeaf->setValueOn(offset, voxel.color);
+            alphaLeaf->setValueOn(offset, voxel.alpha);
+        }
+        else
+        {
+            float totalAlpha = existingAlpha + voxel.alpha;
+            openvdb::Vec3f combinedColor(
+                (existingColor[0] * existingAlpha + voxel.color[0] * voxel.alpha) / totalAlpha,
+                (existingColor[1] * existingAlpha + voxel.color[1] * voxel.alpha) / totalAlpha,
+                (existingColor[2] * existingAlpha + voxel.color[2] * voxel.alpha) / totalAlpha);
+            rgbLeaf->setValueOn(offset, combinedColor);
+            alphaLeaf->setValueOn(offset, totalAlpha);
+        }
+    }
+}
+
+/**
+ * @brief Inserts a zero-padded frame number before the extension of a path
+ * @param path Path such as out.ply
+ * @param frame Frame number
+ * @return Path such as out_0001.ply
+ */
+std::string frameFilename(const std::string &path, int frame)
+{
+    std::filesystem::path filePath(path);
+    std::ostringstream oss;
+    oss << filePath.stem().string() << "_"
+        << std::setw(4) << std::setfill('0') << frame << filePath.extension().string();
+    return (filePath.parent_path() / oss.str()).string();
+}
+
+IoLimiter::IoLimiter(int limit)
+    : mLimit(limit)
+{
+}
+
+void IoLimiter::acquire()
+{
+    if (mLimit <= 0)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [&] { return mActive < mLimit; });
+    mActive++;
+}
+
+void IoLimiter::release()
+{
+    if (mLimit <= 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mActive--;
+    }
+    mCondition.notify_one();
+}
+
+IoScope::IoScope(IoLimiter &limiter)
+    : mLimiter(limiter)
+{
+    mLimiter.acquire();
+}
+
+IoScope::~IoScope()
+{
+    mLimiter.release();
+}
+
+/**
+ * @brief Node concurrency of a frame stage, 0 for no limit besides --jobs
+ */
+size_t stageConcurrency(int jobs)
+{
+    return jobs > 0 ? static_cast<size_t>(jobs) : static_cast<size_t>(tbb::flow::unlimited);
+}
+
+/**
+ * @brief Runs one stage of a frame on its NUMA node, marking the frame failed if the stage throws
+ */
+template <typename Stage>
+void runStage(NumaPlacement &placement, FrameWorkspace &workspace, Stage &&stage)
+{
+    if (workspace.failed)
+    {
+        return;
+    }
+
+    try
+    {
+        placement.execute(workspace.numaNode, std::forward<Stage>(stage));
+    }
+    catch (const std::exception &exception)
+    {
+        workspace.failed = true;
+        workspace.error = exception.what();
+    }
+}
+
+/**
+ * @brief Drops the outputs of a frame; only the buffers meant for reuse stay in the workspace between frames
+ */
+void clearFrameOutputs(FrameWorkspace &workspace)
+{
+    workspace.grids.clear();
+    workspace.levelSetGrid.reset();
+    workspace.mesh = SurfaceMesh();
+}
+
+/**
+ * @brief Writes the grids of a frame to outputDir/prefix_NNNN.vdb
+ */
+void writeVdbFile(const ProgramOptions &options, int frame, const openvdb::GridPtrVec &grids)
+{
+    // Save output
+    std::ostringstream vdbOss;
+    vdbOss << options.outputDir << "/"
+           << options.outputPrefix << "_"
+           << std::setw(4) << std::setfill('0') << frame << ".vdb";
+    std::string outputPath = vdbOss.str();
+
+    // Check if file exists
+    if (std::filesystem::exists(outputPath) && options.verbose)
+    {
+        std::cout << "Overwriting existing file: " << outputPath << std::endl;
+    }
+
+    // Save the file 
+    openvdb::io::File file(outputPath);
+    file.write(grids);
+
+    if (options.summation.deterministic && !stabilizeArchiveFile(outputPath))
+    {
+        std::cerr << "Warning: Could not replace the archive UUID of " << outputPath << std::endl;
+    }
+
+    if (options.verbose)
+    {
+        std::cout << "Saved " << outputPath << std::endl;
+    }
+
+    if (options.verbose)
+    {
+        std::cout << "Saved " << vdbOss.str() << std::endl;
+    }
+}
+
+void decodeFrame(const ProgramOptions &options, const CameraRig &rig, FrameWorkspace &workspace, IoLimiter &io)
+{
+    const int frame = workspace.frame;
+
+    if (options.verbose)
+    {
+        std::cout << "Processing frame " << frame << "..." << std::endl;
+    }
+
+    // Load all views of the rig
+    std::vector<DepthView> &views = workspace.views;
+    views.resize(rig.views.size());
+
+    if (!options.shmInput.empty())
+    {
+        // Raw pixels are decoded in place, without image decode buffers
+        const std::string name = expandFramePattern(options.shmInput, frame);
+        IoScope ioScope(io);
+        if (!loadSharedViews(name, options.depthWindow, options.adaptiveDepth, views, options.verbose))
+        {
+            throw std::runtime_error("could not read the views from " + name);
+        }
+    }
+    else
+    {
+        // Views decode concurrently, each into its own arena
+        while (workspace.arenas.size() < rig.views.size())
+        {
+            workspace.arenas.emplace_back(new FrameArena());
+        }
+
+        // Only the file reads hold an I/O slot. Decoding runs outside it, since a thread waiting in
+        // parallel_for may pick up another frame's stage that blocks on the same limiter.
+        std::vector<std::vector<unsigned char>> &encodedViews = workspace.encodedViews;
+        if (!options.streamInput)
+        {
+            encodedViews.resize(rig.views.size());
+
+            IoScope ioScope(io);
+            for (size_t viewIndex = 0; viewIndex < rig.views.size(); ++viewIndex)
+            {
+                const std::string filename = viewFilename(rig.views[viewIndex], options.baseDir, frame);
+                if (options.verbose)
+                {
+                    std::cout << "Processing view: " << filename << std::endl;
+                }
+
+                if (!readViewFile(filename, encodedViews[viewIndex]))
+                {
+                    throw std::runtime_error("could not read view " + rig.views[viewIndex].name);
+                }
+            }
+        }
+
+        // A view that cannot be decoded fails the whole frame instead of writing a partial volume
+        std::vector<char> loaded(rig.views.size(), 0);
+
+        tbb::parallel_for(
+            size_t(0), rig.views.size(),
+            [&](size_t viewIndex)
+            {
+                FrameArena &arena = *workspace.arenas[viewIndex];
+
+                {
+                    ArenaScope arenaScope(arena);
+
+                    const std::vector<unsigned char> &image = encodedViews[viewIndex];
+                    loaded[viewIndex] = loadDepthView(image.data(), image.size(), options.depthWindow,
+                                                      options.adaptiveDepth, views[viewIndex], options.verbose);
+                }
+
+                // The decoded image has been copied into the view
+                arena.reset();
+            });
+
+        for (size_t viewIndex = 0; viewIndex < rig.views.size(); ++viewIndex)
+        {
+            if (!loaded[viewIndex])
+            {
+                throw std::runtime_error("could not decode view " + rig.views[viewIndex].name);
+            }
+        }
+    }
+}
+
+void reconstructFrame(const ProgramOptions &options, const CameraRig &rig, FrameWorkspace &workspace)
+{
+    const int frame = workspace.frame;
+    const std::vector<DepthView> &views = workspace.views;
+
+    // Create and initialize OpenVDB grids, or clear the ones kept from the previous frame
+    openvdb::Vec3fGrid::Ptr rgbGrid;
+    openvdb::FloatGrid::Ptr alphaGrid;
+
+    if (options.reuseGrids && workspace.rgbGrid)
+    {
+        rgbGrid = workspace.rgbGrid;
+        alphaGrid = workspace.alphaGrid;
+        rgbGrid->clear();
+        alphaGrid->clear();
+        alphaGrid->setGridClass(openvdb::GRID_UNKNOWN);
+    }
+    else
+    {
+        rgbGrid = openvdb::Vec3fGrid::create();
+        alphaGrid = openvdb::FloatGrid::create();
+    }
+
+    if (options.reuseGrids)
+    {
+        workspace.rgbGrid = rgbGrid;
+        workspace.alphaGrid = alphaGrid;
+    }
+
+    rgbGrid->setName("RGB");
+    alphaGrid->setName("Alpha");
+
+    openvdb::GridPtrVec &grids = workspace.grids;
+    grids = {rgbGrid, alphaGrid};
+
+    // Grid whose surface is used for level set conversion
+    openvdb::FloatGrid::Ptr surfaceGrid = alphaGrid;
+
+    // First-surface samples of every view
+    std::vector<VoxelData> &voxelDataList = workspace.voxelDataList;
+    voxelDataList.clear();
+
+    if (options.mode == ReconstructionMode::Surface || !options.pointsPath.empty())
+    {
+        // Non-background tiles bound the number of samples
+        size_t candidatePixels = 0;
+        for (const auto &view : views)
+        {
+            candidatePixels += candidateBounds(view).pixelCount;
+        }
+        voxelDataList.reserve(candidatePixels);
+
+        for (size_t viewIndex = 0; viewIndex < views.size(); ++viewIndex)
+        {
+            if (!views[viewIndex].empty())
+            {
+                processView(views[viewIndex], rig.views[viewIndex], voxelDataList, options.verbose);
+            }
+        }
+    }
+
+    if (options.mode == ReconstructionMode::Carve)
+    {
+        alphaGrid->setGridClass(openvdb::GRID_FOG_VOLUME);
+        carveVolume(views, rig, options.textureSize, rgbGrid, alphaGrid, options.verbose);
+    }
+    else if (options.mode == ReconstructionMode::Tsdf)
+    {
+        auto sdfGrid = fuseTsdf(views, rig, options.textureSize, options.truncation,
+                                rgbGrid, options.summation, options.verbose);
+        sdfGrid->setName("SDF");
+        grids = {rgbGrid, sdfGrid};
+        surfaceGrid = sdfGrid;
+    }
+    else if (options.splat)
+    {
+        splatVoxels(voxelDataList, options.textureSize, options.splatKernel,
+                    options.splatRadius, rgbGrid, alphaGrid, options.summation);
+    }
+    else
+    {
+        // Process voxel data
+        combineVoxels(rgbGrid, alphaGrid, voxelDataList, options.textureSize);
+    }
+
+    if (options.mode == ReconstructionMode::Surface && options.consistencyViews > 0)
+    {
+        filterConsistentVoxels(views, rig, options.consistencyViews, options.consistencyTolerance,
+                               rgbGrid, alphaGrid, options.verbose);
+    }
+
+    openvdb::FloatGrid::Ptr &levelSetGrid = workspace.levelSetGrid;
+    levelSetGrid.reset();
+    if (options.levelSet || !options.meshPath.empty())
+    {
+        levelSetGrid = buildLevelSet(*surfaceGrid, options.bandWidth, options.verbose);
+        levelSetGrid->setName("LevelSet");
+    }
+
+    if (options.levelSet)
+    {
+        grids.push_back(levelSetGrid);
+    }
+
+    // Apply transformations
+    openvdb::math::Transform::Ptr &transform = workspace.transform;
+    transform = openvdb::math::Transform::createLinearTransform();
+    transform->postRotate(M_PI / 2, openvdb::math::X_AXIS);
+
+    for (auto &grid : grids)
+    {
+        grid->setTransform(transform);
+    }
+
+    if (levelSetGrid)
+    {
+        levelSetGrid->setTransform(transform);
+    }
+
+    if (options.lodLevels > 0)
+    {
+        appendLodGrids(grids, options.lodLevels, options.verbose);
+    }
+
+    // Extract the mesh in the same world space as the grids
+    if (!options.meshPath.empty())
+    {
+        workspace.mesh = SurfaceMesh();
+        extractMesh(*levelSetGrid, *rgbGrid, options.adaptivity, workspace.mesh);
+    }
+
+    // Account for the frame's structures while they are all alive
+    FrameMemory &memory = workspace.memory;
+    memory = FrameMemory();
+
+    for (const auto &view : views)
+    {
+        memory.views += view.memUsage();
+    }
+    memory.samples = voxelDataList.capacity() * sizeof(VoxelData);
+    for (const auto &arena : workspace.arenas)
+    {
+        memory.arena += arena->capacity();
+    }
+
+    for (const auto &grid : grids)
+    {
+        memory.grids += grid->memUsage();
+    }
+    if (levelSetGrid && !options.levelSet)
+    {
+        memory.grids += levelSetGrid->memUsage();
+    }
+
+    if (options.memoryReport)
+    {
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(1)
+               << "Frame " << frame << " memory: "
+               << "views " << toMegabytes(memory.views) << " MB, "
+               << "samples " << toMegabytes(memory.samples) << " MB, "
+               << "arena " << toMegabytes(memory.arena) << " MB, "
+               << "grids " << toMegabytes(memory.grids) << " MB, "
+               << "peak RSS " << toMegabytes(peakRssBytes()) << " MB\n";
+        std::cout << report.str() << std::flush;
+    }
+}
+
+void writeFrame(const ProgramOptions &options, FrameWorkspace &workspace, IoLimiter &io)
+{
+    const int frame = workspace.frame;
+    const openvdb::GridPtrVec &grids = workspace.grids;
+
+    if (!options.pointsPath.empty())
+    {
+        // The points are bucketed in parallel before the I/O slot is taken
+        const std::string pointsPath = frameFilename(options.pointsPath, frame);
+        PointCloud cloud;
+        if (!buildPointCloud(pointsPath, workspace.voxelDataList, workspace.transform, cloud))
+        {
+            throw std::runtime_error("could not build the point cloud " + pointsPath);
+        }
+
+        IoScope ioScope(io);
+        if (!writePointCloud(pointsPath, cloud, options.verbose))
+        {
+            throw std::runtime_error("could not write the point cloud " + pointsPath);
+        }
+    }
+
+    if (!options.meshPath.empty())
+    {
+        const SurfaceMesh &mesh = workspace.mesh;
+        std::string meshPath = frameFilename(options.meshPath, frame);
+        IoScope ioScope(io);
+        if (!writeMesh(meshPath, mesh))
+        {
+            throw std::runtime_error("could not write the mesh " + meshPath);
+        }
+
+        if (options.verbose)
+        {
+            std::cout << "Saved " << meshPath << " ("
+                      << mesh.triangles.size() + mesh.quads.size() << " polygons)" << std::endl;
+        }
+    }
+
+    {
+        IoScope ioScope(io);
+
+        if (!options.shmOutput.empty())
+        {
+            const std::string name = expandFramePattern(options.shmOutput, frame);
+            if (!writeSharedGrids(name, grids, options.summation.deterministic, options.verbose))
+            {
+                throw std::runtime_error("could not write the grids to " + name);
+            }
+        }
+        else if (options.streamOutput)
+        {
+            if (!writeStreamGrids(frame, grids, options.summation.deterministic, options.verbose))
+            {
+                throw std::runtime_error("could not write the grids to standard output");
+            }
+        }
+        else
+        {
+            writeVdbFile(options, frame, grids);
+        }
+    }
+
+    clearFrameOutputs(workspace);
+}
+
+bool setupConversion(const ProgramOptions &options, CameraRig &rig, std::ostream &errors)
+{
+    // Validate input directory
+    if (options.shmInput.empty() && !options.streamInput && !std::filesystem::exists(options.baseDir))
+    {
+        errors << "Error: Input directory does not exist: " << options.baseDir << std::endl;
+        return false;
+    }
+
+    // Load the camera rig
+    if (options.rigPath.empty())
+    {
+        rig = cubeRig(options.textureSize);
+    }
+    else if (!loadRig(options.rigPath, rig))
+    {
+        errors << "Error: Could not load camera rig: " << options.rigPath << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void runFramePipeline(const ProgramOptions &settings,
+                      const std::function<bool(FrameRequest &)> &nextFrame,
+                      const std::function<bool(const FrameResult &)> &frameDone)
+{
+    // Each frame in flight holds a workspace, so the pool size bounds the frames in the stages
+    const int jobs = std::max(1, settings.jobs);
+    NumaPlacement placement(settings.numa);
+    WorkspacePool workspaces(jobs, placement.nodeCount());
+    FrameThrottle throttle(settings.memoryBudget);
+    IoLimiter io(settings.ioJobs);
+
+    std::atomic<bool> stopped(false);
+    tbb::flow::graph graph;
+
+    tbb::flow::function_node<FrameWorkspace *, FrameWorkspace *> decode(
+        graph, stageConcurrency(settings.decodeJobs),
+        [&](FrameWorkspace *workspace)
+        {
+            workspace->start = std::chrono::steady_clock::now();
+            runStage(placement, *workspace, [&]()
+                     { decodeFrame(*workspace->options, *workspace->rig, *workspace, io); });
+            return workspace;
+        });
+
+    tbb::flow::function_node<FrameWorkspace *, FrameWorkspace *> voxelize(
+        graph, stageConcurrency(settings.voxelizeJobs),
+        [&](FrameWorkspace *workspace)
+        {
+            runStage(placement, *workspace, [&]()
+                     { reconstructFrame(*workspace->options, *workspace->rig, *workspace); });
+            return workspace;
+        });
+
+    tbb::flow::function_node<FrameWorkspace *, FrameResult> write(
+        graph, stageConcurrency(settings.writeJobs),
+        [&](FrameWorkspace *workspace)
+        {
+            runStage(placement, *workspace, [&]()
+                     { writeFrame(*workspace->options, *workspace, io); });
+
+            // A failed frame may still hold the outputs of the stages it finished
+            clearFrameOutputs(*workspace);
+
+            FrameResult result;
+            result.source = workspace->source;
+            result.frame = workspace->frame;
+            result.failed = workspace->failed;
+            result.error = workspace->error;
+            result.frameBytes = workspace->memory.total();
+            result.start = workspace->start;
+            result.finish = std::chrono::steady_clock::now();
+
+            placement.recordFrame(workspace->numaNode, result.frameBytes);
+            throttle.release(result.frameBytes);
+            workspaces.release(workspace);
+            return result;
+        });
+
+    tbb::flow::function_node<FrameResult, tbb::flow::continue_msg> done(
+        graph, tbb::flow::serial,
+        [&](const FrameResult &result)
+        {
+            if (!frameDone(result))
+            {
+                stopped = true;
+            }
+            return tbb::flow::continue_msg();
+        });
+
+    tbb::flow::make_edge(decode, voxelize);
+    tbb::flow::make_edge(voxelize, write);
+    tbb::flow::make_edge(write, done);
+
+    // Reading a frame and waiting for memory or a workspace block, so frames are admitted
+    // from a thread outside the graph. The graph stays open until that thread is done.
+    std::exception_ptr feedError;
+    graph.reserve_wait();
+
+    std::thread feeder(
+        [&]()
+        {
+            FrameRequest request;
+            try
+            {
+                while (!stopped && nextFrame(request))
+                {
+                    // Hold back the next frame until it fits in the memory budget
+                    throttle.acquire();
+
+                    // Streamed images travel with the frame; the workspace's old buffers take the next read
+                    FrameWorkspace *workspace = workspaces.acquire();
+                    workspace->options = request.options;
+                    workspace->rig = request.rig;
+                    workspace->source = request.source;
+                    workspace->frame = request.frame;
+                    workspace->failed = false;
+                    workspace->error.clear();
+                    workspace->memory = FrameMemory();
+                    workspace->encodedViews.swap(request.encodedViews);
+
+                    decode.try_put(workspace);
+                }
+            }
+            catch (...)
+            {
+                feedError = std::current_exception();
+            }
+            graph.release_wait();
+        });
+
+    graph.wait_for_all();
+    feeder.join();
+
+    if (feedError)
+    {
+        std::rethrow_exception(feedError);
+    }
+
+    if (settings.numa)
+    {
+        placement.report(std::cout);
+    }
+}
+
+bool convertFrames(const ProgramOptions &options, const CameraRig &rig,
+                   const std::function<bool(const FrameResult &)> &frameDone,
+                   const std::function<bool()> &cancelled)
+{
+    // Set once frameDone asks to stop, so a waiting watcher gives up too
+    std::atomic<bool> stopped(false);
+    auto stopRequested = [&]() { return stopped || cancelled(); };
+
+    // Frames come from the frame range, the watched directory or the input stream
+    std::unique_ptr<FrameWatcher> watcher;
+    std::function<bool(FrameRequest &)> nextFrame;
+    bool inputError = false;
+    if (options.streamInput)
+    {
+        // A malformed or truncated record ends the input like the end of the stream, but fails the run
+        nextFrame = [&rig, &inputError](FrameRequest &request)
+        {
+            const StreamRead read = readStreamFrame(rig.views.size(), request.frame, request.encodedViews);
+            inputError = read == StreamRead::Error;
+            return read == StreamRead::Frame;
+        };
+    }
+    else if (options.watch)
+    {
+        watcher = std::make_unique<FrameWatcher>(options.baseDir, rig, options.startFrame,
+                                                 options.endFrame, options.watchSettle);
+        if (!watcher->start())
+        {
+            return false;
+        }
+        nextFrame = [&watcher, &stopRequested](FrameRequest &request)
+        { return watcher->nextFrame(request.frame, stopRequested); };
+    }
+    else
+    {
+        nextFrame = [&options, counter = options.startFrame](FrameRequest &request) mutable
+        {
+            request.frame = counter++;
+            return request.frame <= options.endFrame;
+        };
+    }
+
+    runFramePipeline(
+        options,
+        [&](FrameRequest &request)
+        {
+            request.options = &options;
+            request.rig = &rig;
+            return !stopRequested() && nextFrame(request);
+        },
+        [&](const FrameResult &result)
+        {
+            if (!frameDone(result))
+            {
+                stopped = true;
+            }
+            return !stopped;
+        });
+
+    return !inputError;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file determinism.cpp
+ * @brief Reproducible parallel sums and VDB output independent of the thread count
+ */
+
+#include "determinism.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+
+// Magic number, file version, library major and minor version, grid offsets flag
+constexpr size_t uuidOffset = 8 + 4 + 4 + 4 + 1;
+constexpr size_t uuidLength = 36;
+
+bool isUuid(const std::string &bytes)
+{
+    if (bytes.size() < uuidOffset + uuidLength)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < uuidLength; i++)
+    {
+        const char c = bytes[uuidOffset + i];
+        const bool hyphen = i == 8 || i == 13 || i == 18 || i == 23;
+        if (hyphen ? c != '-' : !std::isxdigit(static_cast<unsigned char>(c)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 64-bit FNV-1a hash of the bytes following the header
+ */
+uint64_t hashContents(const std::string &bytes, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for (size_t i = uuidOffset + uuidLength; i < bytes.size(); i++)
+    {
+        hash ^= static_cast<unsigned char>(bytes[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool stabilizeArchiveBytes(std::string &bytes)
+{
+    if (!isUuid(bytes))
+    {
+        return false;
+    }
+
+    const uint64_t high = hashContents(bytes, 0xcbf29ce484222325ull);
+    const uint64_t low = hashContents(bytes, high);
+
+    char uuid[uuidLength + 1];
+    std::snprintf(uuid, sizeof(uuid), "%08x-%04x-%04x-%04x-%012llx",
+                  static_cast<unsigned>(high >> 32), static_cast<unsigned>((high >> 16) & 0xffff),
+                  static_cast<unsigned>(high & 0xffff), static_cast<unsigned>(low >> 48),
+                  static_cast<unsigned long long>(low & 0xffffffffffffull));
+
+    bytes.replace(uuidOffset, uuidLength, uuid, uuidLength);
+    return true;
+}
+
+bool stabilizeArchiveFile(const std::string &path)
+{
+    std::string bytes;
+    {
+        std::ifstream input(path, std::ios::binary);
+        if (!input)
+        {
+            return false;
+        }
+        bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+
+    if (!stabilizeArchiveBytes(bytes))
+    {
+        return false;
+    }
+
+    std::fstream output(path, std::ios::binary | std::ios::in | std::ios::out);
+    output.seekp(uuidOffset);
+    output.write(bytes.data() + uuidOffset, uuidLength);
+    return static_cast<bool>(output);
+}
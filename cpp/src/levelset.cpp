@@ -0,0 +1,35 @@
+/**
+ * @file levelset.cpp
+ * @brief Narrow-band level set construction from reconstructed grids
+ */
+
+#include "levelset.h"
+
+#include <openvdb/tools/LevelSetRebuild.h>
+#include <openvdb/tools/TopologyToLevelSet.h>
+#include <iostream>
+
+openvdb::FloatGrid::Ptr buildLevelSet(const openvdb::FloatGrid &grid, int bandWidth, bool verbose)
+{
+    openvdb::FloatGrid::Ptr levelSet;
+
+    if (grid.getGridClass() == openvdb::GRID_LEVEL_SET)
+    {
+        levelSet = openvdb::tools::levelSetRebuild(grid, 0.0f, static_cast<float>(bandWidth));
+    }
+    else
+    {
+        levelSet = openvdb::tools::topologyToLevelSet(grid, bandWidth);
+    }
+
+    levelSet->setGridClass(openvdb::GRID_LEVEL_SET);
+
+    if (verbose)
+    {
+        std::cout << "Level set built: " << std::endl
+                  << "  - Band width: " << bandWidth << " voxels" << std::endl
+                  << "  - Band voxels: " << levelSet->activeVoxelCount() << std::endl;
+    }
+
+    return levelSet;
+}
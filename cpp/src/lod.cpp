@@ -0,0 +1,170 @@
+/**
+ * @file lod.cpp
+ * @brief Downsampled level-of-detail grids stored alongside the full resolution ones
+ */
+
+#include "lod.h"
+
+#include <openvdb/tools/SignedFloodFill.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @brief Finds a grid of the given type and name in the frame's grids
+ */
+template <typename GridT>
+typename GridT::Ptr findGrid(const openvdb::GridPtrVec &grids, const std::string &name)
+{
+    for (const auto &grid : grids)
+    {
+        if (grid->getName() == name)
+        {
+            return openvdb::gridPtrCast<GridT>(grid);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Halves the resolution of a grid with a 2x2x2 box filter
+ * @param fine Source grid
+ * @param weights Optional per-voxel weights of the source grid (e.g. alpha)
+ * @param density Average over all eight children, counting inactive ones as zero,
+ *        instead of over the active children only
+ */
+template <typename GridT>
+typename GridT::Ptr downsample(const GridT &fine, const openvdb::FloatGrid *weights, bool density)
+{
+    using LeafT = typename GridT::TreeType::LeafNodeType;
+    using ValueT = typename GridT::ValueType;
+
+    // Coarse leaves covering the fine leaves
+    std::vector<openvdb::Coord> origins;
+    for (auto leaf = fine.tree().cbeginLeaf(); leaf; ++leaf)
+    {
+        origins.push_back((leaf->origin() >> 1) & ~static_cast<openvdb::Int32>(LeafT::DIM - 1));
+    }
+    std::sort(origins.begin(), origins.end());
+    origins.erase(std::unique(origins.begin(), origins.end()), origins.end());
+
+    std::vector<LeafT *> leaves(origins.size(), nullptr);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, origins.size()),
+        [&](const tbb::blocked_range<size_t> &range)
+        {
+            auto accessor = fine.getConstAccessor();
+            std::unique_ptr<openvdb::FloatGrid::ConstAccessor> weightAccessor;
+            if (weights)
+            {
+                weightAccessor.reset(new openvdb::FloatGrid::ConstAccessor(weights->getConstAccessor()));
+            }
+
+            for (size_t i = range.begin(); i < range.end(); i++)
+            {
+                std::unique_ptr<LeafT> leaf(new LeafT(origins[i], fine.background()));
+
+                for (openvdb::Index n = 0; n < LeafT::SIZE; n++)
+                {
+                    const openvdb::Coord base = leaf->offsetToGlobalCoord(n) << 1;
+                    ValueT sum = openvdb::zeroVal<ValueT>();
+                    float weightSum = 0.0f;
+
+                    for (int child = 0; child < 8; child++)
+                    {
+                        const openvdb::Coord ijk = base.offsetBy(child & 1, (child >> 1) & 1, (child >> 2) & 1);
+                        ValueT value;
+                        if (accessor.probeValue(ijk, value))
+                        {
+                            const float weight = weightAccessor ? weightAccessor->getValue(ijk) : 1.0f;
+                            sum = sum + value * weight;
+                            weightSum += weight;
+                        }
+                    }
+
+                    if (weightSum > 0.0f)
+                    {
+                        leaf->setValueOn(n, density ? sum * (1.0f / 8.0f) : sum * (1.0f / weightSum));
+                    }
+                }
+
+                if (!leaf->isEmpty())
+                {
+                    leaves[i] = leaf.release();
+                }
+            }
+        });
+
+    auto coarse = GridT::create(fine.background());
+    for (LeafT *leaf : leaves)
+    {
+        if (leaf)
+        {
+            coarse->tree().addLeaf(leaf);
+        }
+    }
+
+    // Coarse voxel c covers fine voxels 2c and 2c + 1
+    auto transform = fine.transform().copy();
+    transform->preTranslate(openvdb::Vec3d(0.5));
+    transform->preScale(2.0);
+    coarse->setTransform(transform);
+    coarse->setGridClass(fine.getGridClass());
+
+    if (fine.getGridClass() == openvdb::GRID_LEVEL_SET)
+    {
+        openvdb::tools::signedFloodFill(coarse->tree());
+    }
+
+    return coarse;
+}
+
+} // namespace
+
+void appendLodGrids(openvdb::GridPtrVec &grids, int levels, bool verbose)
+{
+    openvdb::Vec3fGrid::Ptr rgbGrid = findGrid<openvdb::Vec3fGrid>(grids, "RGB");
+    openvdb::FloatGrid::Ptr alphaGrid = findGrid<openvdb::FloatGrid>(grids, "Alpha");
+    openvdb::FloatGrid::Ptr sdfGrid = findGrid<openvdb::FloatGrid>(grids, "SDF");
+
+    for (int level = 1; level <= levels; level++)
+    {
+        const std::string suffix = "_lod" + std::to_string(level);
+
+        // Colors are weighted by the finer alpha, so downsample them before alpha
+        if (rgbGrid)
+        {
+            rgbGrid = downsample(*rgbGrid, alphaGrid.get(), false);
+            rgbGrid->setName("RGB" + suffix);
+            grids.push_back(rgbGrid);
+        }
+
+        if (alphaGrid)
+        {
+            alphaGrid = downsample(*alphaGrid, nullptr, true);
+            alphaGrid->setName("Alpha" + suffix);
+            grids.push_back(alphaGrid);
+        }
+
+        if (sdfGrid)
+        {
+            sdfGrid = downsample(*sdfGrid, nullptr, false);
+            sdfGrid->setName("SDF" + suffix);
+            grids.push_back(sdfGrid);
+        }
+
+        if (verbose)
+        {
+            std::cout << "Built LOD " << level << ": "
+                      << (rgbGrid ? rgbGrid->activeVoxelCount() : 0) << " color voxels" << std::endl;
+        }
+    }
+}
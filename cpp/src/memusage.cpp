@@ -0,0 +1,56 @@
+/**
+ * @file memusage.cpp
+ * @brief Per-frame memory accounting and frame throttling under a memory budget
+ */
+
+#include "memusage.h"
+
+#include <algorithm>
+#include <sys/resource.h>
+
+size_t peakRssBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+double toMegabytes(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+FrameThrottle::FrameThrottle(size_t budgetBytes)
+    : mBudget(budgetBytes), mBaseline(peakRssBytes())
+{
+}
+
+void FrameThrottle::acquire()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mCondition.wait(lock, [this]()
+                    { return mBudget == 0 || mInFlight == 0 ||
+                             (mEstimate > 0 && mBaseline + (mInFlight + 1) * mEstimate <= mBudget); });
+
+    mInFlight++;
+}
+
+void FrameThrottle::release(size_t frameBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEstimate = std::max(mEstimate, frameBytes);
+        mInFlight--;
+    }
+    mCondition.notify_all();
+}
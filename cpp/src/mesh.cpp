@@ -0,0 +1,251 @@
+/**
+ * @file mesh.cpp
+ * @brief Surface mesh extraction and export (binary PLY or OBJ)
+ */
+
+#include "mesh.h"
+
+#include <openvdb/tools/VolumeToMesh.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+/**
+ * @brief Averages the active voxels around an index-space position with trilinear weights
+ */
+openvdb::Vec3f sampleActiveColor(const openvdb::Vec3fGrid::ConstAccessor &accessor,
+                                 const openvdb::Vec3d &xyz)
+{
+    const openvdb::Coord base = openvdb::Coord::floor(xyz);
+    const openvdb::Vec3d t = xyz - base.asVec3d();
+
+    openvdb::Vec3f sum(0.0f);
+    float weightSum = 0.0f;
+    openvdb::Vec3f value;
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        const int dx = corner & 1, dy = (corner >> 1) & 1, dz = (corner >> 2) & 1;
+        const float weight = static_cast<float>((dx ? t[0] : 1.0 - t[0]) *
+                                                (dy ? t[1] : 1.0 - t[1]) *
+                                                (dz ? t[2] : 1.0 - t[2]));
+
+        if (weight > 0.0f && accessor.probeValue(base.offsetBy(dx, dy, dz), value))
+        {
+            sum += value * weight;
+            weightSum += weight;
+        }
+    }
+
+    if (weightSum > 0.0f)
+    {
+        return sum / weightSum;
+    }
+
+    // Vertex slightly outside the colored voxels: fall back to its 3^3 neighborhood
+    const openvdb::Coord nearest = openvdb::Coord::round(xyz);
+    int count = 0;
+
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                if (accessor.probeValue(nearest.offsetBy(dx, dy, dz), value))
+                {
+                    sum += value;
+                    count++;
+                }
+            }
+        }
+    }
+
+    return count > 0 ? sum / static_cast<float>(count) : sum;
+}
+
+template <typename T>
+void appendBinary(std::vector<char> &buffer, const T &value)
+{
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * @brief PLY format of the binary values, which appendBinary writes in host byte order
+ */
+const char *hostBinaryFormat()
+{
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t *>(&probe) == 1 ? "binary_little_endian" : "binary_big_endian";
+}
+
+uint8_t toByte(float value)
+{
+    return static_cast<uint8_t>(std::round(std::min(1.0f, std::max(0.0f, value)) * 255.0f));
+}
+
+bool writePly(const std::string &path, const SurfaceMesh &mesh)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    const size_t faceCount = mesh.triangles.size() + mesh.quads.size();
+
+    file << "ply\n"
+         << "format " << hostBinaryFormat() << " 1.0\n"
+         << "element vertex " << mesh.points.size() << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n"
+         << "property uchar red\n"
+         << "property uchar green\n"
+         << "property uchar blue\n";
+
+    if (faceCount > 0)
+    {
+        file << "element face " << faceCount << "\n"
+             << "property list uchar int vertex_indices\n";
+    }
+
+    file << "end_header\n";
+
+    std::vector<char> buffer;
+    buffer.reserve(mesh.points.size() * 15 + mesh.triangles.size() * 13 + mesh.quads.size() * 17);
+
+    for (size_t i = 0; i < mesh.points.size(); i++)
+    {
+        const openvdb::Vec3s &point = mesh.points[i];
+        const openvdb::Vec3f color = i < mesh.colors.size() ? mesh.colors[i] : openvdb::Vec3f(1.0f);
+
+        appendBinary(buffer, point[0]);
+        appendBinary(buffer, point[1]);
+        appendBinary(buffer, point[2]);
+        appendBinary(buffer, toByte(color[0]));
+        appendBinary(buffer, toByte(color[1]));
+        appendBinary(buffer, toByte(color[2]));
+    }
+
+    for (const auto &triangle : mesh.triangles)
+    {
+        appendBinary(buffer, uint8_t(3));
+        for (int k = 0; k < 3; k++)
+        {
+            appendBinary(buffer, static_cast<int32_t>(triangle[k]));
+        }
+    }
+
+    for (const auto &quad : mesh.quads)
+    {
+        appendBinary(buffer, uint8_t(4));
+        for (int k = 0; k < 4; k++)
+        {
+            appendBinary(buffer, static_cast<int32_t>(quad[k]));
+        }
+    }
+
+    file.write(buffer.data(), buffer.size());
+    return static_cast<bool>(file);
+}
+
+bool writeObj(const std::string &path, const SurfaceMesh &mesh)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    // Vertex colors use the common "v x y z r g b" extension
+    for (size_t i = 0; i < mesh.points.size(); i++)
+    {
+        const openvdb::Vec3s &point = mesh.points[i];
+        const openvdb::Vec3f color = i < mesh.colors.size() ? mesh.colors[i] : openvdb::Vec3f(1.0f);
+        file << "v " << point[0] << " " << point[1] << " " << point[2] << " "
+             << color[0] << " " << color[1] << " " << color[2] << "\n";
+    }
+
+    // OBJ indices are 1-based
+    for (const auto &triangle : mesh.triangles)
+    {
+        file << "f " << triangle[0] + 1 << " " << triangle[1] + 1 << " " << triangle[2] + 1 << "\n";
+    }
+
+    for (const auto &quad : mesh.quads)
+    {
+        file << "f " << quad[0] + 1 << " " << quad[1] + 1 << " "
+             << quad[2] + 1 << " " << quad[3] + 1 << "\n";
+    }
+
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+void extractMesh(const openvdb::FloatGrid &levelSet,
+                 const openvdb::Vec3fGrid &rgbGrid,
+                 double adaptivity,
+                 SurfaceMesh &mesh)
+{
+    mesh = SurfaceMesh();
+
+    // Multithreaded internally
+    openvdb::tools::volumeToMesh(levelSet, mesh.points, mesh.triangles, mesh.quads,
+                                 0.0, adaptivity);
+
+    mesh.colors.resize(mesh.points.size());
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, mesh.points.size()),
+        [&](const tbb::blocked_range<size_t> &range)
+        {
+            auto accessor = rgbGrid.getConstAccessor();
+
+            for (size_t i = range.begin(); i < range.end(); i++)
+            {
+                const openvdb::Vec3d xyz =
+                    rgbGrid.transform().worldToIndex(openvdb::Vec3d(mesh.points[i]));
+                mesh.colors[i] = sampleActiveColor(accessor, xyz);
+            }
+        });
+}
+
+bool writeMesh(const std::string &path, const SurfaceMesh &mesh)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    bool written;
+
+    if (extension == ".ply")
+    {
+        written = writePly(path, mesh);
+    }
+    else if (extension == ".obj")
+    {
+        written = writeObj(path, mesh);
+    }
+    else
+    {
+        std::cerr << "Error: Unsupported mesh format: " << path << std::endl;
+        return false;
+    }
+
+    if (!written)
+    {
+        std::cerr << "Error: Could not write mesh: " << path << std::endl;
+    }
+
+    return written;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file numa.cpp
+ * @brief Placement of each frame's work on the threads of one NUMA node
+ */
+
+#include "numa.h"
+#include "memusage.h"
+
+#include <tbb/info.h>
+#include <iomanip>
+#include <sstream>
+
+NumaPlacement::NumaPlacement(bool enabled)
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    // A single node, or -1 when oneTBB cannot see the topology, needs no arenas
+    std::vector<tbb::numa_node_id> nodes = tbb::info::numa_nodes();
+    if (nodes.size() < 2)
+    {
+        return;
+    }
+
+    for (tbb::numa_node_id node : nodes)
+    {
+        mNodeIds.push_back(node);
+        mArenas.emplace_back(new tbb::task_arena(tbb::task_arena::constraints(node)));
+    }
+    mFrames.assign(nodes.size(), 0);
+    mBytes.assign(nodes.size(), 0);
+}
+
+void NumaPlacement::recordFrame(int node, size_t frameBytes)
+{
+    if (mArenas.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFrames[node]++;
+    mBytes[node] += frameBytes;
+}
+
+void NumaPlacement::report(std::ostream &out) const
+{
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1);
+
+    if (mArenas.empty())
+    {
+        report << "NUMA: one node found, frames were not pinned\n";
+        out << report.str() << std::flush;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    size_t localBytes = 0;
+    for (size_t i = 0; i < mArenas.size(); i++)
+    {
+        report << "NUMA node " << mNodeIds[i] << ": " << mFrames[i] << " frames, "
+               << toMegabytes(mBytes[i]) << " MB node-local\n";
+        localBytes += mBytes[i];
+    }
+
+    const double remoteShare = double(mArenas.size() - 1) / mArenas.size();
+    report << "NUMA: estimated cross-node traffic avoided " << toMegabytes(localBytes) * remoteShare
+           << " MB\n";
+    out << report.str() << std::flush;
+}
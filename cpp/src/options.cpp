@@ -0,0 +1,351 @@
+/**
+ * @file options.cpp
+ * @brief Conversion options and their command line parsing
+ */
+
+#include "options.h"
+#include "rig.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+
+/**
+ * @brief Checks a path's extension against two accepted ones, ignoring case
+ */
+bool hasExtension(const std::string &path, const char *first, const char *second)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == first || extension == second;
+}
+
+} // namespace
+
+bool parseOptions(int argc, const char *const argv[], ProgramOptions &options, std::ostream &errors)
+{
+    options = ProgramOptions();
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--start") == 0 && i + 1 < argc)
+        {
+            options.startFrame = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--end") == 0 && i + 1 < argc)
+        {
+            options.endFrame = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+        {
+            options.baseDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--outdir") == 0 && i + 1 < argc)
+        {
+            options.outputDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--prefix") == 0 && i + 1 < argc)
+        {
+            options.outputPrefix = argv[++i];
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            options.textureSize = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--depth-near") == 0 && i + 1 < argc)
+        {
+            options.depthWindow.nearClip = std::stof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--depth-far") == 0 && i + 1 < argc)
+        {
+            options.depthWindow.farClip = std::stof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--adaptive-depth") == 0)
+        {
+            options.adaptiveDepth = true;
+        }
+        else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "surface")
+            {
+                options.mode = ReconstructionMode::Surface;
+            }
+            else if (mode == "carve")
+            {
+                options.mode = ReconstructionMode::Carve;
+            }
+            else if (mode == "tsdf")
+            {
+                options.mode = ReconstructionMode::Tsdf;
+            }
+            else
+            {
+                errors << "Error: Unknown mode: " << mode << std::endl;
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--truncation") == 0 && i + 1 < argc)
+        {
+            options.truncation = std::stof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--levelset") == 0)
+        {
+            options.levelSet = true;
+        }
+        else if (strcmp(argv[i], "--band") == 0 && i + 1 < argc)
+        {
+            options.bandWidth = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+        {
+            options.meshPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--adaptivity") == 0 && i + 1 < argc)
+        {
+            options.adaptivity = std::stod(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--points") == 0 && i + 1 < argc)
+        {
+            options.pointsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--splat") == 0 && i + 1 < argc)
+        {
+            std::string kernel = argv[++i];
+            options.splat = true;
+            if (kernel == "nearest")
+            {
+                options.splatKernel = SplatKernel::Nearest;
+            }
+            else if (kernel == "trilinear")
+            {
+                options.splatKernel = SplatKernel::Trilinear;
+            }
+            else if (kernel == "gaussian")
+            {
+                options.splatKernel = SplatKernel::Gaussian;
+            }
+            else
+            {
+                errors << "Error: Unknown splat kernel: " << kernel << std::endl;
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--splat-radius") == 0 && i + 1 < argc)
+        {
+            options.splatRadius = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rig") == 0 && i + 1 < argc)
+        {
+            options.rigPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--lod") == 0 && i + 1 < argc)
+        {
+            options.lodLevels = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--consistency") == 0 && i + 1 < argc)
+        {
+            options.consistencyViews = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--consistency-tolerance") == 0 && i + 1 < argc)
+        {
+            options.consistencyTolerance = std::stof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            options.jobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--reuse-grids") == 0)
+        {
+            options.reuseGrids = true;
+        }
+        else if (strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc)
+        {
+            options.memoryBudget = std::stoull(argv[++i]) * 1024 * 1024;
+        }
+        else if (strcmp(argv[i], "--memory-report") == 0)
+        {
+            options.memoryReport = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            options.threads = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--io-jobs") == 0 && i + 1 < argc)
+        {
+            options.ioJobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--decode-jobs") == 0 && i + 1 < argc)
+        {
+            options.decodeJobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--voxelize-jobs") == 0 && i + 1 < argc)
+        {
+            options.voxelizeJobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--write-jobs") == 0 && i + 1 < argc)
+        {
+            options.writeJobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--numa") == 0)
+        {
+            options.numa = true;
+        }
+        else if (strcmp(argv[i], "--deterministic") == 0)
+        {
+            options.summation.deterministic = true;
+        }
+        else if (strcmp(argv[i], "--kahan") == 0)
+        {
+            options.summation.compensated = true;
+        }
+        else if (strcmp(argv[i], "--watch") == 0)
+        {
+            options.watch = true;
+        }
+        else if (strcmp(argv[i], "--watch-settle") == 0 && i + 1 < argc)
+        {
+            options.watchSettle = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--shm-input") == 0 && i + 1 < argc)
+        {
+            options.shmInput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--shm-output") == 0 && i + 1 < argc)
+        {
+            options.shmOutput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stdin") == 0)
+        {
+            options.streamInput = true;
+        }
+        else if (strcmp(argv[i], "--stdout") == 0)
+        {
+            options.streamOutput = true;
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            options.batchManifest = argv[++i];
+        }
+        else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc)
+        {
+            options.serverSocket = argv[++i];
+        }
+        else if (strcmp(argv[i], "--server-jobs") == 0 && i + 1 < argc)
+        {
+            options.serverJobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--verbose") == 0)
+        {
+            options.verbose = true;
+        }
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            options.help = true;
+        }
+    }
+
+    if (options.depthWindow.nearClip < 0.0f || options.depthWindow.farClip > 1.0f ||
+        options.depthWindow.nearClip >= options.depthWindow.farClip)
+    {
+        errors << "Error: Depth window must satisfy 0 <= near < far <= 1" << std::endl;
+        return false;
+    }
+
+    if ((options.watch ? 1 : 0) + (options.shmInput.empty() ? 0 : 1) + (options.streamInput ? 1 : 0) > 1)
+    {
+        errors << "Error: Only one of --watch, --shm-input and --stdin can be used" << std::endl;
+        return false;
+    }
+
+    if (options.streamOutput && !options.shmOutput.empty())
+    {
+        errors << "Error: --stdout cannot be combined with --shm-output" << std::endl;
+        return false;
+    }
+
+    // Unwritable formats are rejected before any frame is converted
+    if (!options.meshPath.empty() && !hasExtension(options.meshPath, ".ply", ".obj"))
+    {
+        errors << "Error: --mesh must end in .ply or .obj: " << options.meshPath << std::endl;
+        return false;
+    }
+
+    if (!options.pointsPath.empty() && !hasExtension(options.pointsPath, ".vdb", ".ply"))
+    {
+        errors << "Error: --points must end in .vdb or .ply: " << options.pointsPath << std::endl;
+        return false;
+    }
+
+    // Frames finish concurrently, so each one needs an object of its own
+    if (!options.shmOutput.empty() &&
+        expandFramePattern(options.shmOutput, 0) == expandFramePattern(options.shmOutput, 1))
+    {
+        errors << "Error: --shm-output needs a frame field such as %04d: " << options.shmOutput << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void printUsage(std::ostream &out, const std::string &program)
+{
+    out << "Usage: " << program << " [options]\n"
+        << "Options:\n"
+        << "  --start N        Start frame number (default: 1)\n"
+        << "  --end N          End frame number (default: 25)\n"
+        << "  --dir path       Base directory for textures\n"
+        << "  --outdir path    Output directory for VDB files\n"
+        << "  --prefix name    Prefix for output files (default: volume)\n"
+        << "  --size N         Texture size (default: 128)\n"
+        << "  --rig path       Camera rig JSON file (default: six-view orthographic cube)\n"
+        << "  --depth-near F   Normalized depths below F are background (default: 0.05)\n"
+        << "  --depth-far F    Normalized depths above F are background (default: 0.95)\n"
+        << "  --adaptive-depth Pick the depth window per view from its depth histogram\n"
+        << "  --mode name      Reconstruction mode: surface, carve or tsdf (default: surface)\n"
+        << "  --truncation N   TSDF truncation band half width in voxels (default: 3)\n"
+        << "  --levelset       Also write a narrow-band 'LevelSet' grid\n"
+        << "  --band N         Level set band half width in voxels (default: 3)\n"
+        << "  --mesh path      Also write a mesh per frame (.ply or .obj)\n"
+        << "  --adaptivity F   Mesh adaptivity in [0, 1] (default: 0)\n"
+        << "  --points path    Also write the raw samples per frame (.vdb or .ply)\n"
+        << "  --splat kernel   Splat samples at sub-voxel positions: nearest, trilinear or gaussian\n"
+        << "  --splat-radius N Gaussian splat radius in voxels (default: 1)\n"
+        << "  --lod N          Also store N downsampled levels (RGB_lod1, ...) (default: 0)\n"
+        << "  --consistency K  Keep surface voxels only if K views agree with them (default: off)\n"
+        << "  --consistency-tolerance F\n"
+        << "                   Distance to a view's surface still counted as agreement, in voxels (default: 1.5)\n"
+        << "  --jobs N         Number of frames processed concurrently (default: 1)\n"
+        << "  --threads N      Number of worker threads for the whole process (default: all cores)\n"
+        << "  --reuse-grids    Clear and reuse each worker's grids instead of reallocating them\n"
+        << "  --memory-budget MB\n"
+        << "                   Limit the frames in flight to stay under MB megabytes (default: off)\n"
+        << "  --memory-report  Print the memory used by each frame and the peak RSS\n"
+        << "  --io-jobs N      Number of frames reading or writing files at once (default: no limit)\n"
+        << "  --decode-jobs N  Number of frames decoding their views at once (default: up to --jobs)\n"
+        << "  --voxelize-jobs N\n"
+        << "                   Number of frames building their grids at once (default: up to --jobs)\n"
+        << "  --write-jobs N   Number of frames writing their outputs at once (default: up to --jobs)\n"
+        << "  --numa           Run each frame on the threads of one NUMA node and report the frames per node\n"
+        << "  --deterministic  Produce byte-identical output whatever the number of threads\n"
+        << "  --kahan          Use compensated summation for the splat and TSDF sums\n"
+        << "  --watch          Wait for frames to appear in the input directory and convert them as\n"
+        << "                   their views are complete, until the whole frame range is done\n"
+        << "  --watch-settle MS\n"
+        << "                   Time a frame's files must stay unchanged before it is converted (default: 500)\n"
+        << "  --shm-input name Read each frame's views from a shared memory object, such as /views_%04d\n"
+        << "  --shm-output name\n"
+        << "                   Write each frame's VDB into a shared memory object instead of a file;\n"
+        << "                   the name needs a frame field, such as /volume_%04d\n"
+        << "  --stdin          Read frames of view images from standard input instead of files\n"
+        << "  --stdout         Write length-prefixed VDB frames to standard output instead of files\n"
+        << "  --batch path     Convert the shots listed in a manifest, one line of options per shot\n"
+        << "  --server socket  Serve conversion jobs on a Unix domain socket instead of converting\n"
+        << "  --server-jobs N  Number of jobs the server runs concurrently (default: 2)\n"
+        << "  --verbose        Enable verbose output\n"
+        << "  --help           Show this help message\n";
+}
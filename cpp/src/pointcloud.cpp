@@ -0,0 +1,124 @@
+/**
+ * @file pointcloud.cpp
+ * @brief Export of the raw colored view samples as a point cloud
+ */
+
+#include "pointcloud.h"
+
+#include <openvdb/points/PointConversion.h>
+#include <openvdb/tools/PointIndexGrid.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+
+/**
+ * @brief Lowercase extension of a path, such as .vdb
+ */
+std::string pathExtension(const std::string &path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension;
+}
+
+openvdb::points::PointDataGrid::Ptr buildPointDataGrid(const std::vector<openvdb::Vec3s> &positions,
+                                                       const std::vector<openvdb::Vec3f> &colors,
+                                                       const openvdb::math::Transform::Ptr &transform)
+{
+    using PositionArray = openvdb::points::PointAttributeVector<openvdb::Vec3s>;
+    using ColorArray = openvdb::points::PointAttributeVector<openvdb::Vec3f>;
+
+    const PositionArray positionArray(positions);
+    const ColorArray colorArray(colors);
+
+    // Buckets the points into leaves in parallel; reused to order the attributes
+    auto pointIndexGrid =
+        openvdb::tools::createPointIndexGrid<openvdb::tools::PointIndexGrid>(positionArray, *transform);
+
+    auto pointGrid =
+        openvdb::points::createPointDataGrid<openvdb::points::FixedPointCodec<false>,
+                                             openvdb::points::PointDataGrid>(
+            *pointIndexGrid, positionArray, *transform);
+
+    openvdb::points::appendAttribute<openvdb::Vec3f>(pointGrid->tree(), "Cd");
+    openvdb::points::populateAttribute(pointGrid->tree(), pointIndexGrid->tree(), "Cd", colorArray);
+
+    pointGrid->setName("Points");
+
+    return pointGrid;
+}
+
+} // namespace
+
+bool buildPointCloud(const std::string &path,
+                     const std::vector<VoxelData> &voxelDataList,
+                     const openvdb::math::Transform::Ptr &transform,
+                     PointCloud &cloud)
+{
+    const std::string extension = pathExtension(path);
+    if (extension != ".vdb" && extension != ".ply")
+    {
+        std::cerr << "Error: Unsupported point cloud format: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<openvdb::Vec3s> &positions = cloud.samples.points;
+    std::vector<openvdb::Vec3f> &colors = cloud.samples.colors;
+    positions.resize(voxelDataList.size());
+    colors.resize(voxelDataList.size());
+    cloud.grid.reset();
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, voxelDataList.size()),
+        [&](const tbb::blocked_range<size_t> &range)
+        {
+            for (size_t i = range.begin(); i < range.end(); i++)
+            {
+                // The unprojected position, not the voxel it rounds to
+                const VoxelData &voxel = voxelDataList[i];
+                positions[i] = openvdb::Vec3s(transform->indexToWorld(openvdb::Vec3d(voxel.position)));
+                colors[i] = voxel.color;
+            }
+        });
+
+    if (extension == ".vdb")
+    {
+        cloud.grid = buildPointDataGrid(positions, colors, transform);
+    }
+
+    return true;
+}
+
+bool writePointCloud(const std::string &path, const PointCloud &cloud, bool verbose)
+{
+    if (cloud.grid)
+    {
+        openvdb::io::File file(path);
+        file.write({cloud.grid});
+
+        if (verbose)
+        {
+            std::cout << "Saved " << path << " (" << cloud.samples.points.size() << " points, "
+                      << cloud.grid->memUsage() << " bytes in memory)" << std::endl;
+        }
+        return true;
+    }
+
+    // A mesh without polygons is written as a colored point cloud
+    if (!writeMesh(path, cloud.samples))
+    {
+        return false;
+    }
+
+    if (verbose)
+    {
+        std::cout << "Saved " << path << " (" << cloud.samples.points.size() << " points)" << std::endl;
+    }
+    return true;
+}
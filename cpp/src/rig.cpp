@@ -0,0 +1,418 @@
+/**
+ * @file rig.cpp
+ * @brief Camera rigs: per-view file patterns, intrinsics and camera-to-grid transforms
+ */
+
+#include "rig.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+/**
+ * @brief Axis permutation of the cube views, mapping (depth, column, row) to grid coordinates
+ */
+openvdb::Vec3d permuteCubeAxes(int viewIndex, double x, double y, double z, double last)
+{
+    switch (viewIndex)
+    {
+    case 0: // NX
+        return {last - x, y, z};
+    case 1: // NY
+        return {last - z, last - y, x};
+    case 2: // NZ
+        return {last - y, last - x, z};
+    case 3: // PX
+        return {x, last - y, z};
+    case 4: // PY
+        return {last - z, y, last - x};
+    default: // PZ
+        return {y, x, z};
+    }
+}
+
+openvdb::Vec3d matrixRow(const openvdb::Mat4d &m, int i)
+{
+    return openvdb::Vec3d(m[i][0], m[i][1], m[i][2]);
+}
+
+void setMatrixRow(openvdb::Mat4d &m, int i, const openvdb::Vec3d &v, double w)
+{
+    m[i][0] = v[0];
+    m[i][1] = v[1];
+    m[i][2] = v[2];
+    m[i][3] = w;
+}
+
+/**
+ * @brief Pixel size in camera units; on the plane at unit depth for perspective views
+ */
+void pixelSize(const CameraView &camera, int imageWidth, int imageHeight,
+               double &pixelWidth, double &pixelHeight)
+{
+    if (camera.projection == Projection::Perspective)
+    {
+        // Square pixels, with the vertical field of view spanning the image height
+        pixelHeight = 2.0 * std::tan(0.5 * camera.fovY * M_PI / 180.0) / imageHeight;
+        pixelWidth = pixelHeight;
+    }
+    else
+    {
+        pixelWidth = camera.width / imageWidth;
+        pixelHeight = camera.height / imageHeight;
+    }
+}
+
+std::vector<double> readNumbers(const boost::property_tree::ptree &array)
+{
+    std::vector<double> values;
+    for (const auto &item : array)
+    {
+        values.push_back(item.second.get_value<double>());
+    }
+    return values;
+}
+
+} // namespace
+
+CameraRig cubeRig(int textureSize)
+{
+    static const char *viewNames[6] = {"nx", "ny", "nz", "px", "py", "pz"};
+
+    const double last = textureSize - 1;
+    const double center = 0.5 * last;
+
+    CameraRig rig;
+
+    for (int viewIndex = 0; viewIndex < 6; viewIndex++)
+    {
+        // Grid axes spanned by one step in depth, column and row
+        const openvdb::Vec3d origin = permuteCubeAxes(viewIndex, 0, 0, 0, last);
+        const openvdb::Vec3d colAxis = permuteCubeAxes(viewIndex, 0, 1, 0, last) - origin;
+        const openvdb::Vec3d rowAxis = permuteCubeAxes(viewIndex, 0, 0, 1, last) - origin;
+        const openvdb::Vec3d depthAxis = permuteCubeAxes(viewIndex, 1, 0, 0, last) - origin;
+
+        CameraView camera;
+        camera.name = viewNames[viewIndex];
+        camera.filePattern = std::string("%04d") + viewNames[viewIndex] + ".png";
+        camera.width = textureSize;
+        camera.height = textureSize;
+        camera.nearPlane = 0.0;
+        camera.farPlane = last;
+
+        // Camera X/Y are centered on the image, so pixel (0, 0) sits at -center
+        setMatrixRow(camera.cameraToWorld, 0, colAxis, 0.0);
+        setMatrixRow(camera.cameraToWorld, 1, rowAxis, 0.0);
+        setMatrixRow(camera.cameraToWorld, 2, depthAxis, 0.0);
+        setMatrixRow(camera.cameraToWorld, 3, origin + (colAxis + rowAxis) * center, 1.0);
+
+        rig.views.push_back(camera);
+    }
+
+    compileRig(rig);
+    return rig;
+}
+
+bool loadRig(const std::string &path, CameraRig &rig)
+{
+    namespace pt = boost::property_tree;
+
+    rig = CameraRig();
+
+    try
+    {
+        pt::ptree tree;
+        pt::read_json(path, tree);
+
+        rig.voxelSize = tree.get("voxelSize", 1.0);
+
+        if (auto origin = tree.get_child_optional("origin"))
+        {
+            const std::vector<double> values = readNumbers(*origin);
+            if (values.size() != 3)
+            {
+                std::cerr << "Error: Rig origin must have 3 components: " << path << std::endl;
+                return false;
+            }
+            rig.origin = openvdb::Vec3d(values[0], values[1], values[2]);
+        }
+
+        for (const auto &entry : tree.get_child("views"))
+        {
+            const pt::ptree &node = entry.second;
+
+            CameraView camera;
+            camera.name = node.get<std::string>("name", "view" + std::to_string(rig.views.size()));
+            camera.filePattern = node.get<std::string>("file");
+
+            camera.nearPlane = node.get<double>("near");
+            camera.farPlane = node.get<double>("far");
+
+            const std::string projection = node.get<std::string>("projection", "orthographic");
+            if (projection == "orthographic")
+            {
+                camera.projection = Projection::Orthographic;
+                camera.width = node.get<double>("width");
+                camera.height = node.get<double>("height");
+            }
+            else if (projection == "perspective")
+            {
+                camera.projection = Projection::Perspective;
+                camera.fovY = node.get<double>("fov");
+
+                if (camera.fovY <= 0.0 || camera.fovY >= 180.0 || camera.nearPlane <= 0.0)
+                {
+                    std::cerr << "Error: Perspective view " << camera.name
+                              << " needs 0 < fov < 180 and near > 0" << std::endl;
+                    return false;
+                }
+            }
+            else
+            {
+                std::cerr << "Error: Unsupported projection '" << projection
+                          << "' for view " << camera.name << std::endl;
+                return false;
+            }
+
+            const std::string encoding = node.get<std::string>("depthEncoding", "linear");
+            if (encoding == "linear")
+            {
+                camera.depthEncoding = DepthEncoding::Linear;
+            }
+            else if (encoding == "reverse-z")
+            {
+                camera.depthEncoding = DepthEncoding::ReverseZ;
+            }
+            else
+            {
+                std::cerr << "Error: Unsupported depth encoding '" << encoding
+                          << "' for view " << camera.name << std::endl;
+                return false;
+            }
+
+            const std::vector<double> matrix = readNumbers(node.get_child("cameraToWorld"));
+            if (matrix.size() != 16)
+            {
+                std::cerr << "Error: cameraToWorld must have 16 values for view " << camera.name << std::endl;
+                return false;
+            }
+
+            // The file uses column vectors; openvdb::Mat4d uses row vectors
+            for (int i = 0; i < 4; i++)
+            {
+                for (int j = 0; j < 4; j++)
+                {
+                    camera.cameraToWorld[i][j] = matrix[j * 4 + i];
+                }
+            }
+
+            rig.views.push_back(camera);
+        }
+    }
+    catch (const pt::ptree_error &e)
+    {
+        std::cerr << "Error: Invalid rig file " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    if (rig.views.empty())
+    {
+        std::cerr << "Error: Rig has no views: " << path << std::endl;
+        return false;
+    }
+
+    compileRig(rig);
+    return true;
+}
+
+void compileRig(CameraRig &rig)
+{
+    openvdb::Mat4d worldToIndex = openvdb::Mat4d::identity();
+    setMatrixRow(worldToIndex, 0, openvdb::Vec3d(1.0 / rig.voxelSize, 0, 0), 0.0);
+    setMatrixRow(worldToIndex, 1, openvdb::Vec3d(0, 1.0 / rig.voxelSize, 0), 0.0);
+    setMatrixRow(worldToIndex, 2, openvdb::Vec3d(0, 0, 1.0 / rig.voxelSize), 0.0);
+    setMatrixRow(worldToIndex, 3, -rig.origin / rig.voxelSize, 1.0);
+
+    for (auto &camera : rig.views)
+    {
+        camera.cameraToIndex = camera.cameraToWorld * worldToIndex;
+        camera.indexToCamera = camera.cameraToIndex.inverse();
+        camera.voxelsPerDepthUnit = matrixRow(camera.cameraToIndex, 2).length();
+    }
+}
+
+std::string expandFramePattern(const std::string &pattern, int frame)
+{
+    std::ostringstream oss;
+
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] != '%')
+        {
+            oss << pattern[i];
+            continue;
+        }
+
+        size_t j = i + 1;
+        if (j < pattern.size() && pattern[j] == '%')
+        {
+            oss << '%';
+            i = j;
+            continue;
+        }
+
+        const bool zeroPad = j < pattern.size() && pattern[j] == '0';
+        int width = 0;
+        while (j < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[j])))
+        {
+            width = width * 10 + (pattern[j] - '0');
+            j++;
+        }
+
+        if (j < pattern.size() && pattern[j] == 'd')
+        {
+            oss << std::setw(width) << std::setfill(zeroPad ? '0' : ' ') << frame;
+            i = j;
+        }
+        else
+        {
+            oss << '%';
+        }
+    }
+
+    return oss.str();
+}
+
+std::string viewFilename(const CameraView &camera, const std::string &baseDir, int frame)
+{
+    return baseDir + expandFramePattern(camera.filePattern, frame);
+}
+
+bool matchViewFilename(const CameraView &camera, const std::string &filename, int &frame)
+{
+    const std::string &pattern = camera.filePattern;
+    size_t n = 0;
+    bool hasFrame = false;
+
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] == '%')
+        {
+            size_t j = i + 1;
+            if (j < pattern.size() && pattern[j] == '%')
+            {
+                if (n >= filename.size() || filename[n] != '%')
+                {
+                    return false;
+                }
+                n++;
+                i = j;
+                continue;
+            }
+
+            while (j < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[j])))
+            {
+                j++;
+            }
+
+            if (j < pattern.size() && pattern[j] == 'd')
+            {
+                const size_t begin = n;
+                while (n < filename.size() && std::isdigit(static_cast<unsigned char>(filename[n])))
+                {
+                    n++;
+                }
+                if (n == begin || n - begin > 9)
+                {
+                    return false;
+                }
+                frame = std::stoi(filename.substr(begin, n - begin));
+                hasFrame = true;
+                i = j;
+                continue;
+            }
+        }
+
+        if (n >= filename.size() || filename[n] != pattern[i])
+        {
+            return false;
+        }
+        n++;
+    }
+
+    return hasFrame && n == filename.size();
+}
+
+PixelUnprojector makeUnprojector(const CameraView &camera, int imageWidth, int imageHeight)
+{
+    const openvdb::Vec3d xAxis = matrixRow(camera.cameraToIndex, 0);
+    const openvdb::Vec3d yAxis = matrixRow(camera.cameraToIndex, 1);
+    const openvdb::Vec3d zAxis = matrixRow(camera.cameraToIndex, 2);
+    const openvdb::Vec3d translation = matrixRow(camera.cameraToIndex, 3);
+
+    double pixelWidth, pixelHeight;
+    pixelSize(camera, imageWidth, imageHeight, pixelWidth, pixelHeight);
+
+    // Pixel centers: camera x = (col + 0.5 - imageWidth / 2) * pixelWidth, at unit depth for perspective
+    const openvdb::Vec3d corner = xAxis * ((0.5 - 0.5 * imageWidth) * pixelWidth) +
+                                  yAxis * ((0.5 - 0.5 * imageHeight) * pixelHeight);
+
+    PixelUnprojector unprojector;
+    unprojector.base = translation;
+    unprojector.colStep = openvdb::Vec3d(0.0);
+    unprojector.rowStep = openvdb::Vec3d(0.0);
+    unprojector.direction = zAxis;
+    unprojector.colDirStep = openvdb::Vec3d(0.0);
+    unprojector.rowDirStep = openvdb::Vec3d(0.0);
+
+    if (camera.projection == Projection::Perspective)
+    {
+        unprojector.direction = zAxis + corner;
+        unprojector.colDirStep = xAxis * pixelWidth;
+        unprojector.rowDirStep = yAxis * pixelHeight;
+    }
+    else
+    {
+        unprojector.base = translation + corner;
+        unprojector.colStep = xAxis * pixelWidth;
+        unprojector.rowStep = yAxis * pixelHeight;
+    }
+
+    return unprojector;
+}
+
+bool projectToPixel(const CameraView &camera, const openvdb::Vec3d &xyz,
+                    int imageWidth, int imageHeight, int &col, int &row, double &depth)
+{
+    const openvdb::Vec3d p = camera.indexToCamera.transform(xyz);
+    depth = p[2];
+
+    double pixelWidth, pixelHeight;
+    pixelSize(camera, imageWidth, imageHeight, pixelWidth, pixelHeight);
+
+    // Perspective views divide by depth to get back to the unit image plane
+    double scale = 1.0;
+    if (camera.projection == Projection::Perspective)
+    {
+        if (depth <= 0.0)
+        {
+            return false;
+        }
+        scale = 1.0 / depth;
+    }
+
+    const double u = p[0] * scale / pixelWidth + 0.5 * imageWidth - 0.5;
+    const double v = p[1] * scale / pixelHeight + 0.5 * imageHeight - 0.5;
+
+    col = static_cast<int>(std::floor(u + 0.5));
+    row = static_cast<int>(std::floor(v + 0.5));
+
+    return col >= 0 && col < imageWidth && row >= 0 && row < imageHeight;
+}
@@ -0,0 +1,324 @@
+/**
+ * @file server.cpp
+ * @brief Conversion server accepting jobs over a Unix domain socket
+ */
+
+#include "server.h"
+#include "convert.h"
+#include "options.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr size_t maxRequestSize = 64 * 1024;
+
+/**
+ * @class JobQueue
+ * @brief Admits jobs in arrival order, at most maxJobs at a time
+ */
+class JobQueue
+{
+public:
+    explicit JobQueue(int maxJobs)
+        : mMaxJobs(std::max(1, maxJobs))
+    {
+    }
+
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        const long ticket = mNextTicket++;
+        mCondition.wait(lock, [&] { return ticket < mFinished + mMaxJobs; });
+    }
+
+    void release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFinished++;
+        }
+        mCondition.notify_all();
+    }
+
+private:
+    int mMaxJobs;
+    long mNextTicket = 0;
+    long mFinished = 0;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+/**
+ * @brief Reads a job's arguments, one per line up to an empty line
+ */
+bool readRequest(int fd, std::vector<std::string> &args)
+{
+    std::string request;
+    char buffer[4096];
+
+    while (request.find("\n\n") == std::string::npos && request != "\n")
+    {
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0 || request.size() + length > maxRequestSize)
+        {
+            return false;
+        }
+        request.append(buffer, static_cast<size_t>(length));
+    }
+
+    std::istringstream lines(request);
+    std::string line;
+    while (std::getline(lines, line) && !line.empty())
+    {
+        args.push_back(line);
+    }
+    return true;
+}
+
+bool sendLine(int fd, const std::string &line)
+{
+    const std::string data = line + "\n";
+    size_t sent = 0;
+
+    while (sent < data.size())
+    {
+        const ssize_t length = write(fd, data.data() + sent, data.size() - sent);
+        if (length <= 0)
+        {
+            return false;
+        }
+        sent += static_cast<size_t>(length);
+    }
+    return true;
+}
+
+/**
+ * @brief Sends every line of a text as a message
+ */
+void sendMessages(int fd, const std::string &text)
+{
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        sendLine(fd, "message " + line);
+    }
+}
+
+/**
+ * @brief Checks without blocking whether the client has closed its connection
+ *
+ * Clients send nothing after the request, so a readable socket with no data means end of file.
+ */
+bool clientGone(int fd)
+{
+    pollfd descriptor{fd, POLLIN, 0};
+    if (poll(&descriptor, 1, 0) <= 0)
+    {
+        return false;
+    }
+    if (descriptor.revents & (POLLHUP | POLLERR))
+    {
+        return true;
+    }
+
+    char byte;
+    return recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+/**
+ * @brief Makes a relative path absolute against the client's working directory
+ */
+void resolvePath(const std::string &workingDir, std::string &path)
+{
+    if (!path.empty() && path[0] != '/')
+    {
+        path = workingDir + "/" + path;
+    }
+}
+
+/**
+ * @brief Runs one job and reports its progress
+ * @param fd Connection of the client
+ * @param request Client's working directory followed by the job's arguments
+ * @return true if the job completed
+ */
+bool runJob(int fd, const std::vector<std::string> &request)
+{
+    if (request.empty() || request[0].empty() || request[0][0] != '/')
+    {
+        sendMessages(fd, "Error: The job must start with the absolute working directory of the client");
+        return false;
+    }
+    const std::string &workingDir = request[0];
+
+    std::vector<const char *> argv{"multiview-volume"};
+    for (size_t i = 1; i < request.size(); i++)
+    {
+        argv.push_back(request[i].c_str());
+    }
+
+    std::ostringstream errors;
+
+    try
+    {
+        ProgramOptions options;
+        if (!parseOptions(static_cast<int>(argv.size()), argv.data(), options, errors))
+        {
+            sendMessages(fd, errors.str());
+            return false;
+        }
+
+        if (options.help)
+        {
+            std::ostringstream usage;
+            printUsage(usage, argv[0]);
+            sendMessages(fd, usage.str());
+            return true;
+        }
+
+        // --threads would change the thread count of the whole server, under every other job
+        if (!options.serverSocket.empty() || !options.batchManifest.empty() ||
+            options.streamInput || options.streamOutput || options.threads > 0)
+        {
+            sendMessages(fd, "Error: --server, --batch, --stdin, --stdout and --threads are not allowed in a job");
+            return false;
+        }
+
+        // Paths are the client's, not the server's
+        resolvePath(workingDir, options.baseDir);
+        resolvePath(workingDir, options.outputDir);
+        resolvePath(workingDir, options.rigPath);
+        resolvePath(workingDir, options.meshPath);
+        resolvePath(workingDir, options.pointsPath);
+
+        CameraRig rig;
+        if (!setupConversion(options, rig, errors))
+        {
+            sendMessages(fd, errors.str());
+            return false;
+        }
+
+        // A failed send means the client is gone, which cancels the job
+        bool connected = true;
+        int failedFrames = 0;
+        const bool converted = convertFrames(
+            options, rig,
+            [fd, &connected, &failedFrames](const FrameResult &result)
+            {
+                if (result.failed)
+                {
+                    failedFrames++;
+                    connected = sendLine(fd, "message Error: Frame " + std::to_string(result.frame) +
+                                                 " failed: " + result.error);
+                }
+                else
+                {
+                    connected = sendLine(fd, "frame " + std::to_string(result.frame));
+                }
+                return connected;
+            },
+            [fd]() { return clientGone(fd); });
+
+        if (!converted)
+        {
+            sendMessages(fd, "Error: Could not obtain the frames to convert");
+        }
+        return converted && connected && failedFrames == 0;
+    }
+    catch (const std::exception &exception)
+    {
+        sendMessages(fd, std::string("Error: ") + exception.what());
+        return false;
+    }
+}
+
+void serveClient(int fd, JobQueue &queue)
+{
+    std::vector<std::string> args;
+    if (readRequest(fd, args))
+    {
+        queue.acquire();
+        const bool succeeded = runJob(fd, args);
+        queue.release();
+
+        sendLine(fd, succeeded ? "ok" : "failed");
+    }
+    close(fd);
+}
+
+} // namespace
+
+bool runServer(const std::string &socketPath, int maxJobs)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: Socket path is too long: " << socketPath << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // Writes to a client that went away must fail instead of ending the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str());
+    if (listener < 0 ||
+        bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(listener, SOMAXCONN) < 0)
+    {
+        std::cerr << "Error: Could not listen on socket: " << socketPath << std::endl;
+        return false;
+    }
+
+    std::cout << "Serving conversion jobs on " << socketPath << std::endl;
+
+    JobQueue queue(maxJobs);
+
+    for (;;)
+    {
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "Error: Failed to accept connection on " << socketPath << std::endl;
+            close(listener);
+            return false;
+        }
+
+        std::thread(serveClient, client, std::ref(queue)).detach();
+    }
+}
+
+#else
+
+bool runServer(const std::string &socketPath, int)
+{
+    std::cerr << "Error: Server mode requires Unix domain sockets: " << socketPath << std::endl;
+    return false;
+}
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file shm.cpp
+ * @brief Exchange of view buffers and VDB frames through POSIX shared memory
+ */
+
+#include "shm.h"
+#include "determinism.h"
+
+#include <openvdb/io/Stream.h>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool loadSharedViews(const std::string &name, const DepthWindow &window, bool adaptive,
+                     std::vector<DepthView> &views, bool verbose)
+{
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) < 0)
+    {
+        std::cerr << "Error: Could not open shared memory views: " << name << std::endl;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(status.st_size);
+    void *mapping = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map shared memory views: " << name << std::endl;
+        return false;
+    }
+
+    const unsigned char *data = static_cast<const unsigned char *>(mapping);
+    bool valid = size >= sizeof(SharedViewsHeader);
+
+    SharedViewsHeader header;
+    if (valid)
+    {
+        std::memcpy(&header, data, sizeof(header));
+        valid = std::memcmp(header.magic, "MVVW", 4) == 0 &&
+                header.version == sharedFormatVersion &&
+                header.viewCount == views.size();
+    }
+
+    // Pixels are decoded straight from the mapping
+    size_t offset = sizeof(SharedViewsHeader);
+    for (size_t viewIndex = 0; valid && viewIndex < views.size(); viewIndex++)
+    {
+        SharedViewHeader viewHeader;
+        if (offset + sizeof(viewHeader) > size)
+        {
+            valid = false;
+            break;
+        }
+        std::memcpy(&viewHeader, data + offset, sizeof(viewHeader));
+        offset += sizeof(viewHeader);
+
+        const size_t pixelBytes = static_cast<size_t>(viewHeader.width) * viewHeader.height * 4 * sizeof(uint16_t);
+        if (offset + pixelBytes > size)
+        {
+            valid = false;
+            break;
+        }
+
+        if (verbose)
+        {
+            std::cout << "Processing shared view " << viewIndex << ": "
+                      << viewHeader.width << "x" << viewHeader.height << std::endl;
+        }
+
+        decodeDepthView(reinterpret_cast<const uint16_t *>(data + offset),
+                        static_cast<int>(viewHeader.width), static_cast<int>(viewHeader.height),
+                        window, adaptive, views[viewIndex], verbose);
+        offset += pixelBytes;
+    }
+
+    munmap(mapping, size);
+
+    if (!valid)
+    {
+        std::cerr << "Error: Malformed shared memory views: " << name << std::endl;
+        for (auto &view : views)
+        {
+            view = DepthView();
+        }
+    }
+    return valid;
+}
+
+bool writeSharedGrids(const std::string &name, const openvdb::GridPtrVec &grids, bool stableHeader, bool verbose)
+{
+    std::ostringstream stream(std::ios_base::binary);
+    openvdb::io::Stream(stream).write(grids);
+    std::string bytes = stream.str();
+    if (stableHeader)
+    {
+        stabilizeArchiveBytes(bytes);
+    }
+
+    SharedGridsHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.version = sharedFormatVersion;
+    header.size = bytes.size();
+    const size_t size = sizeof(header) + bytes.size();
+
+    // Emptying the object first zeroes a magic left from an earlier frame, so a consumer
+    // mapping it early does not take a partly written frame for a complete one
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, 0) < 0 || ftruncate(fd, static_cast<off_t>(size)) < 0)
+    {
+        std::cerr << "Error: Could not create shared memory output: " << name << std::endl;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map shared memory output: " << name << std::endl;
+        return false;
+    }
+
+    // The payload and the size go first; the magic is published last, after a release fence
+    unsigned char *data = static_cast<unsigned char *>(mapping);
+    std::memcpy(data + sizeof(header), bytes.data(), bytes.size());
+    std::memcpy(data, &header, sizeof(header));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(data + offsetof(SharedGridsHeader, magic), "MVDB", 4);
+    munmap(mapping, size);
+
+    if (verbose)
+    {
+        std::cout << "Saved " << bytes.size() << " bytes to shared memory " << name << std::endl;
+    }
+
+    return true;
+}
+
+#else
+
+bool loadSharedViews(const std::string &name, const DepthWindow &, bool,
+                     std::vector<DepthView> &, bool)
+{
+    std::cerr << "Error: Shared memory input requires POSIX shared memory: " << name << std::endl;
+    return false;
+}
+
+bool writeSharedGrids(const std::string &name, const openvdb::GridPtrVec &, bool, bool)
+{
+    std::cerr << "Error: Shared memory output requires POSIX shared memory: " << name << std::endl;
+    return false;
+}
+
+#endif
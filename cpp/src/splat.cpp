@@ -0,0 +1,250 @@
+/**
+ * @file splat.cpp
+ * @brief Sub-voxel splatting of view samples into the color and alpha grids
+ */
+
+#include "splat.h"
+
+#include <openvdb/tools/Composite.h>
+#include <openvdb/tree/LeafManager.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+
+constexpr size_t splatBatchSize = 256;
+
+/**
+ * @brief Sort key grouping samples by the 8^3 leaf node containing them
+ */
+uint64_t leafKey(const openvdb::Vec3s &position)
+{
+    const uint64_t x = static_cast<uint64_t>(std::max(0, static_cast<int>(position[0]))) >> 3;
+    const uint64_t y = static_cast<uint64_t>(std::max(0, static_cast<int>(position[1]))) >> 3;
+    const uint64_t z = static_cast<uint64_t>(std::max(0, static_cast<int>(position[2]))) >> 3;
+    return (x << 42) | (y << 21) | z;
+}
+
+/**
+ * @struct SplatAccumulator
+ * @brief tbb::parallel_reduce body accumulating weighted samples per voxel
+ */
+struct SplatAccumulator
+{
+    const std::vector<VoxelData> &samples;
+    const std::vector<uint32_t> &order;
+    int textureSize;
+    SplatKernel kernel;
+    int radius;
+    bool compensated;
+    openvdb::FloatGrid::Ptr weightSum;
+    openvdb::Vec3fGrid::Ptr colorSum;
+    openvdb::FloatGrid::Ptr weightError; ///< Kahan compensation of weightSum
+    openvdb::Vec3fGrid::Ptr colorError;  ///< Kahan compensation of colorSum
+
+    SplatAccumulator(const std::vector<VoxelData> &samples, const std::vector<uint32_t> &order,
+                     int textureSize, SplatKernel kernel, int radius, bool compensated)
+        : samples(samples), order(order), textureSize(textureSize), kernel(kernel), radius(radius),
+          compensated(compensated),
+          weightSum(openvdb::FloatGrid::create()), colorSum(openvdb::Vec3fGrid::create()),
+          weightError(openvdb::FloatGrid::create()), colorError(openvdb::Vec3fGrid::create())
+    {
+    }
+
+    SplatAccumulator(SplatAccumulator &other, tbb::split)
+        : SplatAccumulator(other.samples, other.order, other.textureSize, other.kernel, other.radius,
+                           other.compensated)
+    {
+    }
+
+    void operator()(const tbb::blocked_range<size_t> &range)
+    {
+        auto weightAccessor = weightSum->getAccessor();
+        auto colorAccessor = colorSum->getAccessor();
+        auto weightErrorAccessor = weightError->getAccessor();
+        auto colorErrorAccessor = colorError->getAccessor();
+        const openvdb::CoordBBox domain(openvdb::Coord(0), openvdb::Coord(textureSize - 1));
+
+        // Structure-of-arrays batch buffers
+        std::array<float, splatBatchSize> px, py, pz, fx, fy, fz;
+        std::array<int, splatBatchSize> bx, by, bz;
+
+        // Trilinear weights are taken from the lower corner, the other kernels center on the nearest voxel
+        const float bias = kernel == SplatKernel::Trilinear ? 0.0f : 0.5f;
+
+        const float sigma = 0.5f * std::max(1, radius);
+        const float falloff = -1.0f / (2.0f * sigma * sigma);
+        const int extent = kernel == SplatKernel::Gaussian ? radius : 0;
+        std::vector<float> weights((2 * extent + 1) * (2 * extent + 1) * (2 * extent + 1));
+
+        auto accumulate = [&](const openvdb::Coord &ijk, float weight, const openvdb::Vec3f &color)
+        {
+            if (weight <= 0.0f || !domain.isInside(ijk))
+            {
+                return;
+            }
+            if (compensated)
+            {
+                compensatedAccumulate(weightAccessor, weightErrorAccessor, ijk, weight);
+                compensatedAccumulate(colorAccessor, colorErrorAccessor, ijk, openvdb::Vec3f(color * weight));
+                return;
+            }
+            weightAccessor.modifyValue(ijk, [weight](float &value) { value += weight; });
+            colorAccessor.modifyValue(ijk, [&](openvdb::Vec3f &value) { value += color * weight; });
+        };
+
+        for (size_t begin = range.begin(); begin < range.end(); begin += splatBatchSize)
+        {
+            const size_t count = std::min(splatBatchSize, range.end() - begin);
+
+            for (size_t k = 0; k < count; k++)
+            {
+                const openvdb::Vec3s &position = samples[order[begin + k]].position;
+                px[k] = position[0];
+                py[k] = position[1];
+                pz[k] = position[2];
+            }
+
+            // Branch-free weight setup over the whole batch
+            for (size_t k = 0; k < count; k++)
+            {
+                bx[k] = static_cast<int>(std::floor(px[k] + bias));
+                by[k] = static_cast<int>(std::floor(py[k] + bias));
+                bz[k] = static_cast<int>(std::floor(pz[k] + bias));
+                fx[k] = px[k] - bx[k];
+                fy[k] = py[k] - by[k];
+                fz[k] = pz[k] - bz[k];
+            }
+
+            for (size_t k = 0; k < count; k++)
+            {
+                const VoxelData &sample = samples[order[begin + k]];
+                const openvdb::Coord base(bx[k], by[k], bz[k]);
+
+                if (kernel == SplatKernel::Nearest)
+                {
+                    accumulate(base, sample.alpha, sample.color);
+                }
+                else if (kernel == SplatKernel::Trilinear)
+                {
+                    for (int corner = 0; corner < 8; corner++)
+                    {
+                        const int dx = corner & 1, dy = (corner >> 1) & 1, dz = (corner >> 2) & 1;
+                        const float weight = (dx ? fx[k] : 1.0f - fx[k]) *
+                                             (dy ? fy[k] : 1.0f - fy[k]) *
+                                             (dz ? fz[k] : 1.0f - fz[k]);
+                        accumulate(base.offsetBy(dx, dy, dz), weight * sample.alpha, sample.color);
+                    }
+                }
+                else
+                {
+                    float total = 0.0f;
+                    size_t n = 0;
+
+                    for (int dz = -extent; dz <= extent; dz++)
+                    {
+                        for (int dy = -extent; dy <= extent; dy++)
+                        {
+                            for (int dx = -extent; dx <= extent; dx++, n++)
+                            {
+                                const float ex = dx - fx[k], ey = dy - fy[k], ez = dz - fz[k];
+                                weights[n] = std::exp((ex * ex + ey * ey + ez * ez) * falloff);
+                                total += weights[n];
+                            }
+                        }
+                    }
+
+                    n = 0;
+                    for (int dz = -extent; dz <= extent; dz++)
+                    {
+                        for (int dy = -extent; dy <= extent; dy++)
+                        {
+                            for (int dx = -extent; dx <= extent; dx++, n++)
+                            {
+                                accumulate(base.offsetBy(dx, dy, dz),
+                                           weights[n] / total * sample.alpha, sample.color);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void join(SplatAccumulator &other)
+    {
+        if (compensated)
+        {
+            compensatedJoin(*weightSum, *weightError, *other.weightSum, *other.weightError);
+            compensatedJoin(*colorSum, *colorError, *other.colorSum, *other.colorError);
+            return;
+        }
+        openvdb::tools::compSum(*weightSum, *other.weightSum);
+        openvdb::tools::compSum(*colorSum, *other.colorSum);
+    }
+};
+
+} // namespace
+
+void splatVoxels(const std::vector<VoxelData> &voxelDataList,
+                 int textureSize,
+                 SplatKernel kernel,
+                 int radius,
+                 openvdb::Vec3fGrid::Ptr rgbGrid,
+                 openvdb::FloatGrid::Ptr alphaGrid,
+                 const SummationOptions &summation)
+{
+    // Order samples by leaf so consecutive writes hit the accessors' cached leaf
+    std::vector<std::pair<uint64_t, uint32_t>> keys(voxelDataList.size());
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, voxelDataList.size()),
+        [&](const tbb::blocked_range<size_t> &range)
+        {
+            for (size_t i = range.begin(); i < range.end(); i++)
+            {
+                keys[i] = {leafKey(voxelDataList[i].position), static_cast<uint32_t>(i)};
+            }
+        });
+
+    tbb::parallel_sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> order(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        order[i] = keys[i].second;
+    }
+
+    SplatAccumulator splat(voxelDataList, order, textureSize, kernel, radius, summation.compensated);
+    reduceRange(tbb::blocked_range<size_t>(0, order.size(), splatBatchSize), splat, summation);
+
+    if (summation.compensated)
+    {
+        foldCompensation(*splat.weightSum, *splat.weightError);
+        foldCompensation(*splat.colorSum, *splat.colorError);
+    }
+
+    // Turn the weighted color sums into averages; both trees share the same topology
+    const openvdb::FloatTree &weightTree = splat.weightSum->tree();
+    openvdb::tree::LeafManager<openvdb::Vec3fTree> leafManager(splat.colorSum->tree());
+
+    leafManager.foreach(
+        [&](openvdb::Vec3fTree::LeafNodeType &leaf, size_t)
+        {
+            const auto *weightLeaf = weightTree.probeConstLeaf(leaf.origin());
+
+            for (auto iter = leaf.beginValueOn(); iter; ++iter)
+            {
+                iter.setValue(*iter / weightLeaf->getValue(iter.pos()));
+            }
+        });
+
+    rgbGrid->tree().merge(splat.colorSum->tree());
+    alphaGrid->tree().merge(splat.weightSum->tree());
+}
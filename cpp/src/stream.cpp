@@ -0,0 +1,144 @@
+/**
+ * @file stream.cpp
+ * @brief Framed view input on stdin and length-prefixed VDB output on stdout
+ */
+
+#include "stream.h"
+#include "determinism.h"
+
+#include <openvdb/io/Stream.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr uint64_t maxStreamImageSize = uint64_t(1) << 30;
+
+int outputDescriptor = -1;
+std::mutex outputMutex;
+
+bool readExactly(void *data, size_t size)
+{
+    return std::fread(data, 1, size, stdin) == size;
+}
+
+} // namespace
+
+StreamRead readStreamFrame(size_t viewCount, int &frame, std::vector<std::vector<unsigned char>> &images)
+{
+    StreamFrameHeader header;
+    const size_t headerBytes = std::fread(&header, 1, sizeof(header), stdin);
+    if (headerBytes == 0 && std::feof(stdin))
+    {
+        return StreamRead::End;
+    }
+
+    if (headerBytes != sizeof(header) || std::memcmp(header.magic, "MVFR", 4) != 0 ||
+        header.viewCount != viewCount)
+    {
+        std::cerr << "Error: Malformed frame header on standard input" << std::endl;
+        return StreamRead::Error;
+    }
+
+    images.resize(viewCount);
+    for (auto &image : images)
+    {
+        uint64_t size;
+        if (!readExactly(&size, sizeof(size)) || size > maxStreamImageSize)
+        {
+            std::cerr << "Error: Malformed view record in frame " << header.frame << std::endl;
+            return StreamRead::Error;
+        }
+
+        image.resize(static_cast<size_t>(size));
+        if (!readExactly(image.data(), image.size()))
+        {
+            std::cerr << "Error: Truncated view image in frame " << header.frame << std::endl;
+            return StreamRead::Error;
+        }
+    }
+
+    frame = static_cast<int>(header.frame);
+    return StreamRead::Frame;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+bool claimStandardOutput()
+{
+    std::cout.flush();
+    std::fflush(stdout);
+
+    outputDescriptor = dup(STDOUT_FILENO);
+    if (outputDescriptor < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+        std::cerr << "Error: Could not redirect standard output" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeStreamGrids(int frame, const openvdb::GridPtrVec &grids, bool stableHeader, bool verbose)
+{
+    std::ostringstream stream(std::ios_base::binary);
+    openvdb::io::Stream(stream).write(grids);
+    std::string bytes = stream.str();
+    if (stableHeader)
+    {
+        stabilizeArchiveBytes(bytes);
+    }
+
+    StreamGridsHeader header;
+    std::memcpy(header.magic, "MVDB", 4);
+    header.frame = static_cast<uint32_t>(frame);
+    header.size = bytes.size();
+
+    std::string record(reinterpret_cast<const char *>(&header), sizeof(header));
+    record += bytes;
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+
+    size_t written = 0;
+    while (written < record.size())
+    {
+        const ssize_t length = write(outputDescriptor, record.data() + written, record.size() - written);
+        if (length <= 0)
+        {
+            std::cerr << "Error: Could not write frame " << frame << " to standard output" << std::endl;
+            return false;
+        }
+        written += static_cast<size_t>(length);
+    }
+
+    if (verbose)
+    {
+        std::cout << "Streamed frame " << frame << " (" << bytes.size() << " bytes)" << std::endl;
+    }
+
+    return true;
+}
+
+#else
+
+bool claimStandardOutput()
+{
+    std::cerr << "Error: Streaming to standard output requires POSIX descriptors" << std::endl;
+    return false;
+}
+
+bool writeStreamGrids(int frame, const openvdb::GridPtrVec &, bool, bool)
+{
+    std::cerr << "Error: Could not write frame " << frame << " to standard output" << std::endl;
+    return false;
+}
+
+#endif
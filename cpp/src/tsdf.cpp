@@ -0,0 +1,231 @@
+/**
+ * @file tsdf.cpp
+ * @brief Truncated signed distance fusion of the depth views
+ */
+
+#include "tsdf.h"
+
+#include <openvdb/tools/ChangeBackground.h>
+#include <openvdb/tools/Composite.h>
+#include <openvdb/tools/SignedFloodFill.h>
+#include <openvdb/tree/LeafManager.h>
+#include <tbb/blocked_range.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+
+constexpr size_t deterministicRowGrain = 16;
+
+/**
+ * @struct TsdfRow
+ * @brief One pixel row of one view, the unit of parallel work
+ */
+struct TsdfRow
+{
+    int viewIndex;
+    int z;
+};
+
+/**
+ * @struct TsdfAccumulator
+ * @brief tbb::parallel_reduce body summing distances, weights and colors per voxel
+ */
+struct TsdfAccumulator
+{
+    const std::vector<DepthView> &views;
+    const CameraRig &rig;
+    const std::vector<TsdfRow> &rows;
+    int textureSize;
+    float truncation;
+    bool compensated;
+    openvdb::FloatGrid::Ptr distanceSum;
+    openvdb::FloatGrid::Ptr weightSum; ///< Whole sample counts, exact without compensation
+    openvdb::Vec3fGrid::Ptr colorSum;
+    openvdb::FloatGrid::Ptr distanceError; ///< Kahan compensation of distanceSum
+    openvdb::Vec3fGrid::Ptr colorError;    ///< Kahan compensation of colorSum
+
+    TsdfAccumulator(const std::vector<DepthView> &views, const CameraRig &rig,
+                    const std::vector<TsdfRow> &rows, int textureSize, float truncation, bool compensated)
+        : views(views), rig(rig), rows(rows), textureSize(textureSize), truncation(truncation),
+          compensated(compensated),
+          distanceSum(openvdb::FloatGrid::create()), weightSum(openvdb::FloatGrid::create()),
+          colorSum(openvdb::Vec3fGrid::create()),
+          distanceError(openvdb::FloatGrid::create()), colorError(openvdb::Vec3fGrid::create())
+    {
+    }
+
+    TsdfAccumulator(TsdfAccumulator &other, tbb::split)
+        : TsdfAccumulator(other.views, other.rig, other.rows, other.textureSize, other.truncation,
+                          other.compensated)
+    {
+    }
+
+    void operator()(const tbb::blocked_range<size_t> &range)
+    {
+        auto distanceAccessor = distanceSum->getAccessor();
+        auto weightAccessor = weightSum->getAccessor();
+        auto colorAccessor = colorSum->getAccessor();
+        auto distanceErrorAccessor = distanceError->getAccessor();
+        auto colorErrorAccessor = colorError->getAccessor();
+
+        const openvdb::CoordBBox domain(openvdb::Coord(0), openvdb::Coord(textureSize - 1));
+
+        for (size_t i = range.begin(); i < range.end(); i++)
+        {
+            const TsdfRow &row = rows[i];
+            const DepthView &view = views[row.viewIndex];
+            const CameraView &camera = rig.views[row.viewIndex];
+
+            // Steps are taken in whole voxels along the view direction
+            const PixelUnprojector unprojector = makeUnprojector(camera, view.width, view.height);
+            const PixelRow pixelRow = unprojector.row(row.z);
+            const double voxelsPerDepthUnit = camera.voxelsPerDepthUnit;
+
+            const int tileY = row.z / depthTileSize;
+
+            for (int tileX = 0; tileX < view.tilesX; tileX++)
+            {
+                if (view.isBackgroundTile(tileX, tileY))
+                {
+                    continue;
+                }
+
+                const int end = std::min(view.width, (tileX + 1) * depthTileSize);
+                for (int y = tileX * depthTileSize; y < end; y++)
+                {
+                    const size_t pixel = static_cast<size_t>(row.z) * view.width + y;
+                    const float depth = view.depth[pixel];
+
+                    if (view.isBackground(depth))
+                    {
+                        continue;
+                    }
+
+                    // Unquantized surface position along the view direction, in voxels
+                    const float surface = static_cast<float>(cameraDepth(camera, depth) * voxelsPerDepthUnit);
+                    const int first = static_cast<int>(std::floor(surface - truncation));
+                    const int last = static_cast<int>(std::ceil(surface + truncation));
+                    const openvdb::Vec3f color = view.color[pixel];
+
+                    for (int x = first; x <= last; x++)
+                    {
+                        const openvdb::Coord ijk =
+                            openvdb::Coord::round(unprojector.unproject(pixelRow, y, x / voxelsPerDepthUnit));
+                        if (!domain.isInside(ijk))
+                        {
+                            continue;
+                        }
+
+                        const float distance = std::min(truncation, std::max(-truncation, surface - x));
+
+                        weightAccessor.modifyValue(ijk, [](float &value) { value += 1.0f; });
+
+                        if (compensated)
+                        {
+                            compensatedAccumulate(distanceAccessor, distanceErrorAccessor, ijk, distance);
+                            compensatedAccumulate(colorAccessor, colorErrorAccessor, ijk, color);
+                        }
+                        else
+                        {
+                            distanceAccessor.modifyValue(ijk, [distance](float &value) { value += distance; });
+                            colorAccessor.modifyValue(ijk, [&color](openvdb::Vec3f &value) { value += color; });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void join(TsdfAccumulator &other)
+    {
+        openvdb::tools::compSum(*weightSum, *other.weightSum);
+
+        if (compensated)
+        {
+            compensatedJoin(*distanceSum, *distanceError, *other.distanceSum, *other.distanceError);
+            compensatedJoin(*colorSum, *colorError, *other.colorSum, *other.colorError);
+        }
+        else
+        {
+            openvdb::tools::compSum(*distanceSum, *other.distanceSum);
+            openvdb::tools::compSum(*colorSum, *other.colorSum);
+        }
+    }
+};
+
+} // namespace
+
+openvdb::FloatGrid::Ptr fuseTsdf(const std::vector<DepthView> &views,
+                                 const CameraRig &rig,
+                                 int textureSize,
+                                 float truncation,
+                                 openvdb::Vec3fGrid::Ptr rgbGrid,
+                                 const SummationOptions &summation,
+                                 bool verbose)
+{
+    std::vector<TsdfRow> rows;
+
+    for (int viewIndex = 0; viewIndex < static_cast<int>(views.size()); viewIndex++)
+    {
+        const DepthView &view = views[viewIndex];
+        const TileBounds bounds = candidateBounds(view);
+
+        // Rows outside the non-background tiles hold no surface samples
+        for (int z = bounds.minRow; z <= bounds.maxRow; z++)
+        {
+            rows.push_back({viewIndex, z});
+        }
+    }
+
+    // A fixed split goes down to the grain size, so deterministic runs take rows in groups
+    const size_t grainSize = summation.deterministic ? deterministicRowGrain : 1;
+
+    TsdfAccumulator fusion(views, rig, rows, textureSize, truncation, summation.compensated);
+    reduceRange(tbb::blocked_range<size_t>(0, rows.size(), grainSize), fusion, summation);
+
+    if (summation.compensated)
+    {
+        foldCompensation(*fusion.distanceSum, *fusion.distanceError);
+        foldCompensation(*fusion.colorSum, *fusion.colorError);
+    }
+
+    // Normalize the sums; the three trees share the same topology
+    openvdb::tree::LeafManager<openvdb::FloatTree> leafManager(fusion.distanceSum->tree());
+    const openvdb::FloatTree &weightTree = fusion.weightSum->tree();
+    openvdb::Vec3fTree &colorTree = fusion.colorSum->tree();
+
+    leafManager.foreach(
+        [&](openvdb::FloatTree::LeafNodeType &leaf, size_t)
+        {
+            const auto *weightLeaf = weightTree.probeConstLeaf(leaf.origin());
+            auto *colorLeaf = colorTree.probeLeaf(leaf.origin());
+
+            for (auto iter = leaf.beginValueOn(); iter; ++iter)
+            {
+                const float weight = weightLeaf->getValue(iter.pos());
+                iter.setValue(*iter / weight);
+                colorLeaf->setValueOnly(iter.pos(), colorLeaf->getValue(iter.pos()) / weight);
+            }
+        });
+
+    // Inactive voxels become +/- truncation depending on which side of the surface they lie
+    openvdb::FloatTree::Ptr sdfTree = fusion.distanceSum->treePtr();
+    openvdb::tools::changeBackground(*sdfTree, truncation);
+    openvdb::tools::signedFloodFill(*sdfTree);
+
+    auto sdfGrid = openvdb::FloatGrid::create(sdfTree);
+    sdfGrid->setGridClass(openvdb::GRID_LEVEL_SET);
+
+    rgbGrid->tree().merge(colorTree);
+
+    if (verbose)
+    {
+        std::cout << "TSDF fusion complete: " << std::endl
+                  << "  - Truncation: " << truncation << " voxels" << std::endl
+                  << "  - Band voxels: " << sdfGrid->activeVoxelCount() << std::endl;
+    }
+
+    return sdfGrid;
+}
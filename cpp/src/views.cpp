@@ -0,0 +1,399 @@
+/**
+ * @file views.cpp
+ * @brief Decoding of view depth maps into grid samples
+ */
+
+#include "arena.h"
+
+// Decode buffers come from the frame's arena when one is bound
+#define STBI_MALLOC(size) arenaMalloc(size)
+#define STBI_REALLOC_SIZED(pointer, oldSize, newSize) arenaRealloc(pointer, oldSize, newSize)
+#define STBI_FREE(pointer) arenaFree(pointer)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "views.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+
+/**
+ * @brief Places the clip planes in the empty gaps separating end-of-range spikes from geometry
+ * @param histogram Pixel count per depth bin; bin b holds depth b / 255
+ * @param fallback Clip planes kept for ends with a spike but no gap
+ */
+DepthWindow adaptDepthWindow(const std::array<size_t, 256> &histogram, const DepthWindow &fallback)
+{
+    DepthWindow window;
+    window.nearClip = 0.0f;
+    window.farClip = 1.0f;
+
+    int lo = 0;
+    while (lo < 256 && histogram[lo] == 0)
+    {
+        lo++;
+    }
+    if (lo == 256)
+    {
+        return fallback;
+    }
+
+    int hi = 255;
+    while (histogram[hi] == 0)
+    {
+        hi--;
+    }
+
+    // Near end: populated run starting at depth 0, then empty bins, then geometry
+    if (histogram[0] > 0)
+    {
+        int runEnd = 0;
+        while (runEnd <= hi && histogram[runEnd] > 0)
+        {
+            runEnd++;
+        }
+        int geometry = runEnd;
+        while (geometry <= hi && histogram[geometry] == 0)
+        {
+            geometry++;
+        }
+        window.nearClip = geometry <= hi ? 0.5f * (runEnd - 1 + geometry) / 255.0f : fallback.nearClip;
+    }
+
+    // Far end: populated run ending at depth 1, preceded by empty bins
+    if (histogram[255] > 0)
+    {
+        int runStart = 255;
+        while (runStart >= lo && histogram[runStart] > 0)
+        {
+            runStart--;
+        }
+        int geometry = runStart;
+        while (geometry >= lo && histogram[geometry] == 0)
+        {
+            geometry--;
+        }
+        window.farClip = geometry >= lo ? 0.5f * (geometry + runStart + 1) / 255.0f : fallback.farClip;
+    }
+
+    return window;
+}
+
+/**
+ * @brief Histogram bin of an alpha value; bin b holds depth b / 255
+ */
+int depthBin(unsigned char alpha)
+{
+    return 255 - alpha;
+}
+
+int depthBin(uint16_t alpha)
+{
+    return (65535 - alpha) >> 8;
+}
+
+/**
+ * @brief Empties a view while keeping the capacity of its buffers
+ */
+void clearDepthView(DepthView &view)
+{
+    view.width = 0;
+    view.height = 0;
+    view.depth.clear();
+    view.color.clear();
+    view.tileMinDepth.clear();
+    view.tileMaxDepth.clear();
+}
+
+/**
+ * @brief Decodes RGBA pixels whose alpha stores one minus the normalized depth
+ * @tparam Channel unsigned char for 8-bit images, uint16_t for 16-bit buffers
+ */
+template <typename Channel>
+void decodeDepthPixels(const Channel *pixels, int width, int height, const DepthWindow &window,
+                       bool adaptive, DepthView &view, bool verbose)
+{
+    const Channel maxValue = std::numeric_limits<Channel>::max();
+    const float scale = static_cast<float>(maxValue);
+
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    view.width = width;
+    view.height = height;
+    view.depth.resize(pixelCount);
+    view.color.resize(pixelCount);
+    view.window = window;
+    view.tilesX = (width + depthTileSize - 1) / depthTileSize;
+    view.tilesY = (height + depthTileSize - 1) / depthTileSize;
+
+    std::array<size_t, 256> histogram{};
+    std::vector<Channel> tileMinAlpha(static_cast<size_t>(view.tilesX) * view.tilesY, maxValue);
+    std::vector<Channel> tileMaxAlpha(tileMinAlpha.size(), 0);
+
+    // Alpha range of each tile span, in a loop of its own that reads only the alpha
+    // channel so the min/max reduction vectorizes
+    for (int row = 0; row < height; row++)
+    {
+        const size_t tileRow = static_cast<size_t>(row / depthTileSize) * view.tilesX;
+
+        for (int tileX = 0; tileX < view.tilesX; tileX++)
+        {
+            const size_t begin = static_cast<size_t>(row) * width + tileX * depthTileSize;
+            const size_t end = static_cast<size_t>(row) * width + std::min(width, (tileX + 1) * depthTileSize);
+            Channel minAlpha = tileMinAlpha[tileRow + tileX];
+            Channel maxAlpha = tileMaxAlpha[tileRow + tileX];
+
+            for (size_t i = begin; i < end; i++)
+            {
+                const Channel alpha = pixels[i * 4 + 3];
+                minAlpha = std::min(minAlpha, alpha);
+                maxAlpha = std::max(maxAlpha, alpha);
+            }
+
+            tileMinAlpha[tileRow + tileX] = minAlpha;
+            tileMaxAlpha[tileRow + tileX] = maxAlpha;
+        }
+    }
+
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        const Channel *pixel = pixels + i * 4;
+        view.color[i] = openvdb::Vec3f(pixel[0] / scale, pixel[1] / scale, pixel[2] / scale);
+        view.depth[i] = 1.0f - pixel[3] / scale;
+        histogram[depthBin(pixel[3])]++;
+    }
+
+    // Same expression as the per-pixel depth, so tile and pixel tests agree exactly
+    view.tileMinDepth.resize(tileMinAlpha.size());
+    view.tileMaxDepth.resize(tileMinAlpha.size());
+    for (size_t tile = 0; tile < tileMinAlpha.size(); tile++)
+    {
+        view.tileMinDepth[tile] = 1.0f - tileMaxAlpha[tile] / scale;
+        view.tileMaxDepth[tile] = 1.0f - tileMinAlpha[tile] / scale;
+    }
+
+    if (adaptive)
+    {
+        view.window = adaptDepthWindow(histogram, window);
+
+        if (verbose)
+        {
+            std::cout << "Adaptive depth window: ["
+                      << view.window.nearClip << ", " << view.window.farClip << "]" << std::endl;
+        }
+    }
+}
+
+} // namespace
+
+bool loadDepthView(const std::string &filename, const DepthWindow &window, bool adaptive,
+                   DepthView &view, bool verbose)
+{
+    if (verbose)
+    {
+        std::cout << "Processing view: " << filename << std::endl;
+    }
+
+    // Keep the buffers' capacity so views reused across frames do not reallocate
+    clearDepthView(view);
+
+    int width, height, channels;
+    unsigned char *img = stbi_load(filename.c_str(), &width, &height, &channels, 4);
+
+    if (img == nullptr)
+    {
+        std::cerr << "Error in loading the image: " << filename << std::endl;
+        return false;
+    }
+
+    if (verbose)
+    {
+        std::cout << "Image loaded successfully: "
+                  << width << "x" << height
+                  << " with " << channels << " channels" << std::endl;
+    }
+
+    decodeDepthPixels(img, width, height, window, adaptive, view, verbose);
+
+    stbi_image_free(img);
+
+    return true;
+}
+
+bool readViewFile(const std::string &filename, std::vector<unsigned char> &data)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        std::cerr << "Error in loading the image: " << filename << std::endl;
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size())))
+    {
+        std::cerr << "Error in reading the image: " << filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool loadDepthView(const unsigned char *data, size_t size, const DepthWindow &window, bool adaptive,
+                   DepthView &view, bool verbose)
+{
+    clearDepthView(view);
+
+    int width, height, channels;
+    unsigned char *img = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, 4);
+
+    if (img == nullptr)
+    {
+        std::cerr << "Error in decoding an image of " << size << " bytes" << std::endl;
+        return false;
+    }
+
+    if (verbose)
+    {
+        std::cout << "Image decoded successfully: "
+                  << width << "x" << height
+                  << " with " << channels << " channels" << std::endl;
+    }
+
+    decodeDepthPixels(img, width, height, window, adaptive, view, verbose);
+
+    stbi_image_free(img);
+
+    return true;
+}
+
+void decodeDepthView(const uint16_t *pixels, int width, int height, const DepthWindow &window,
+                     bool adaptive, DepthView &view, bool verbose)
+{
+    clearDepthView(view);
+    decodeDepthPixels(pixels, width, height, window, adaptive, view, verbose);
+}
+
+TileBounds candidateBounds(const DepthView &view)
+{
+    TileBounds bounds;
+
+    for (int tileY = 0; tileY < view.tilesY; tileY++)
+    {
+        for (int tileX = 0; tileX < view.tilesX; tileX++)
+        {
+            if (view.isBackgroundTile(tileX, tileY))
+            {
+                continue;
+            }
+
+            const int minCol = tileX * depthTileSize;
+            const int minRow = tileY * depthTileSize;
+            const int maxCol = std::min(view.width, minCol + depthTileSize) - 1;
+            const int maxRow = std::min(view.height, minRow + depthTileSize) - 1;
+
+            if (bounds.empty())
+            {
+                bounds.minCol = minCol;
+                bounds.minRow = minRow;
+                bounds.maxCol = maxCol;
+                bounds.maxRow = maxRow;
+            }
+            else
+            {
+                bounds.minCol = std::min(bounds.minCol, minCol);
+                bounds.minRow = std::min(bounds.minRow, minRow);
+                bounds.maxCol = std::max(bounds.maxCol, maxCol);
+                bounds.maxRow = std::max(bounds.maxRow, maxRow);
+            }
+            bounds.pixelCount += static_cast<size_t>(maxCol - minCol + 1) * (maxRow - minRow + 1);
+        }
+    }
+
+    return bounds;
+}
+
+std::vector<float> surfaceDepths(const DepthView &view, const CameraView &camera)
+{
+    std::vector<float> surface(view.depth.size());
+
+    for (size_t pixel = 0; pixel < view.depth.size(); pixel++)
+    {
+        const float depth = view.depth[pixel];
+        surface[pixel] = view.isBackground(depth)
+                             ? std::numeric_limits<float>::infinity()
+                             : static_cast<float>(cameraDepth(camera, depth) * camera.voxelsPerDepthUnit);
+    }
+
+    return surface;
+}
+
+void processView(const DepthView &view,
+                 const CameraView &camera,
+                 std::vector<VoxelData> &voxelDataList,
+                 bool verbose)
+{
+    int processedVoxels = 0;
+    int skippedVoxels = 0;
+
+    const PixelUnprojector unprojector = makeUnprojector(camera, view.width, view.height);
+
+    // Row-major so pixels are read in memory order and each row's ray is set up once
+    for (int z = 0; z < view.height; z++)
+    {
+        const PixelRow pixelRow = unprojector.row(z);
+        const int tileY = z / depthTileSize;
+
+        for (int tileX = 0; tileX < view.tilesX; tileX++)
+        {
+            const int begin = tileX * depthTileSize;
+            const int end = std::min(view.width, begin + depthTileSize);
+
+            if (view.isBackgroundTile(tileX, tileY))
+            {
+                skippedVoxels += end - begin;
+                continue;
+            }
+
+            for (int y = begin; y < end; y++)
+            {
+                const size_t pixel = static_cast<size_t>(z) * view.width + y;
+                float depth = view.depth[pixel];
+
+                if (view.isBackground(depth))
+                {
+                    skippedVoxels++;
+                    continue;
+                }
+
+                const openvdb::Vec3d position = unprojector.unproject(pixelRow, y, cameraDepth(camera, depth));
+                const openvdb::Coord ijk = openvdb::Coord::round(position);
+
+                VoxelData voxel;
+                voxel.x = ijk.x();
+                voxel.y = ijk.y();
+                voxel.z = ijk.z();
+                voxel.position = openvdb::Vec3s(position);
+                voxel.color = view.color[pixel];
+                voxel.alpha = 1.0;
+
+                voxelDataList.push_back(voxel);
+                processedVoxels++;
+            }
+        }
+    }
+
+    if (verbose)
+    {
+        std::cout << "View processing complete: " << std::endl
+                  << "  - Processed voxels: " << processedVoxels << std::endl
+                  << "  - Skipped voxels: " << skippedVoxels << std::endl;
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * @file watch.cpp
+ * @brief Watch-folder ingestion: reports frames once all their views are written
+ */
+
+#include "watch.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FrameWatcher::FrameWatcher(const std::string &baseDir, const CameraRig &rig,
+                           int startFrame, int endFrame, int settleMilliseconds)
+    : mBaseDir(baseDir), mRig(rig), mStartFrame(startFrame), mEndFrame(endFrame),
+      mSettle(settleMilliseconds)
+{
+}
+
+FrameWatcher::~FrameWatcher()
+{
+#ifdef __linux__
+    if (mFd >= 0)
+    {
+        close(mFd);
+    }
+#endif
+}
+
+bool FrameWatcher::start()
+{
+#ifdef __linux__
+    mFd = inotify_init1(IN_CLOEXEC);
+    if (mFd < 0 ||
+        inotify_add_watch(mFd, mBaseDir.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO) < 0)
+    {
+        std::cerr << "Error: Could not watch directory: " << mBaseDir << std::endl;
+        return false;
+    }
+
+    // Files written before the watch was set up
+    for (const auto &entry : std::filesystem::directory_iterator(mBaseDir))
+    {
+        if (entry.is_regular_file())
+        {
+            fileWritten(entry.path().filename().string());
+        }
+    }
+
+    return true;
+#else
+    std::cerr << "Error: Watch mode requires inotify (Linux)" << std::endl;
+    return false;
+#endif
+}
+
+void FrameWatcher::fileWritten(const std::string &filename)
+{
+    for (size_t viewIndex = 0; viewIndex < mRig.views.size(); viewIndex++)
+    {
+        int frame;
+        if (!matchViewFilename(mRig.views[viewIndex], filename, frame) ||
+            frame < mStartFrame || frame > mEndFrame)
+        {
+            continue;
+        }
+
+        // A frame reported earlier is not converted again
+        PendingFrame &pending = mPending[frame];
+        if (pending.reported)
+        {
+            continue;
+        }
+        if (pending.present.empty())
+        {
+            pending.present.resize(mRig.views.size(), false);
+        }
+        pending.present[viewIndex] = true;
+        pending.lastWrite = Clock::now();
+    }
+}
+
+bool FrameWatcher::readEvents(int timeoutMilliseconds)
+{
+#ifdef __linux__
+    pollfd descriptor{mFd, POLLIN, 0};
+    const int ready = poll(&descriptor, 1, timeoutMilliseconds);
+    if (ready < 0)
+    {
+        return errno == EINTR;
+    }
+    if (ready == 0)
+    {
+        return true;
+    }
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    const ssize_t length = read(mFd, buffer, sizeof(buffer));
+    if (length < 0)
+    {
+        return errno == EINTR || errno == EAGAIN;
+    }
+
+    for (ssize_t offset = 0; offset < length;)
+    {
+        const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+        if (event->len > 0)
+        {
+            fileWritten(event->name);
+        }
+        offset += sizeof(inotify_event) + event->len;
+    }
+
+    return true;
+#else
+    (void)timeoutMilliseconds;
+    return false;
+#endif
+}
+
+bool FrameWatcher::nextFrame(int &frame, const std::function<bool()> &cancelled)
+{
+    const int frameCount = mEndFrame - mStartFrame + 1;
+
+    while (mReported < frameCount)
+    {
+        if (cancelled())
+        {
+            return false;
+        }
+
+        const Clock::time_point now = Clock::now();
+        // Waits are bounded so a cancelled conversion does not sit in poll until the next file event
+        Clock::duration wait = std::chrono::milliseconds(cancelCheckMilliseconds);
+        int readyFrame = -1;
+
+        for (const auto &entry : mPending)
+        {
+            const PendingFrame &pending = entry.second;
+            if (pending.reported ||
+                !std::all_of(pending.present.begin(), pending.present.end(), [](bool present) { return present; }))
+            {
+                continue;
+            }
+
+            const Clock::time_point settled = pending.lastWrite + mSettle;
+            if (settled <= now)
+            {
+                readyFrame = entry.first;
+                break;
+            }
+            wait = std::min(wait, settled - now);
+        }
+
+        if (readyFrame >= 0)
+        {
+            // The entry is kept so later writes to the frame's files are ignored
+            PendingFrame &pending = mPending[readyFrame];
+            pending.reported = true;
+            pending.present.clear();
+            pending.present.shrink_to_fit();
+            mReported++;
+            frame = readyFrame;
+            return true;
+        }
+
+        const int timeout = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(wait).count()) + 1;
+        if (!readEvents(timeout))
+        {
+            std::cerr << "Error: Failed to read file events from " << mBaseDir << std::endl;
+            return false;
+        }
+    }
+
+    return false;
+}
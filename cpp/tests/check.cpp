@@ -0,0 +1,383 @@
+/**
+ * @file check.cpp
+ * @brief Regression checks run by CTest: golden grid statistics, identical output across thread counts and per-frame time
+ *
+ * Usage:
+ *   multiview-volume-check golden <golden.txt> <output.vdb> <converter> [options...]
+ *   multiview-volume-check identical <dir1> <dirN> <threads> <converter> [options...]
+ *   multiview-volume-check perf <baseline.txt> <tolerance> <frames> <converter> [options...]
+ *
+ * Every check runs the converter with the given options first. A missing
+ * golden or baseline file fails the test. With the MULTIVIEW_RECORD
+ * environment variable set, the golden and baseline files are written from
+ * the current build instead of being compared.
+ */
+
+#include <openvdb/openvdb.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr int perfRuns = 3;
+
+bool recording()
+{
+    const char *record = std::getenv("MULTIVIEW_RECORD");
+    return record && *record && std::strcmp(record, "0") != 0;
+}
+
+/**
+ * @brief Runs the converter and waits for it
+ * @return true if it exited with status 0
+ */
+bool runConverter(char *const args[])
+{
+    std::cout.flush();
+
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "Error: Could not start " << args[0] << std::endl;
+        return false;
+    }
+    if (pid == 0)
+    {
+        execv(args[0], args);
+        std::cerr << "Error: Could not run " << args[0] << ": " << std::strerror(errno) << std::endl;
+        _exit(127);
+    }
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "Error: " << args[0] << " failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief FNV-1a accumulation of raw bytes
+ */
+void hashBytes(uint64_t &hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+}
+
+/**
+ * @brief Hash of the coordinates and values of the active voxels, in tree order
+ */
+template <typename GridType>
+uint64_t valueChecksum(const GridType &grid)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (auto iter = grid.cbeginValueOn(); iter; ++iter)
+    {
+        // Tiles are hashed with their extent, so a tile and its voxels differ
+        openvdb::CoordBBox box;
+        iter.getBoundingBox(box);
+        const openvdb::Int32 extent[6] = {box.min().x(), box.min().y(), box.min().z(),
+                                          box.max().x(), box.max().y(), box.max().z()};
+        const typename GridType::ValueType value = *iter;
+        hashBytes(hash, extent, sizeof(extent));
+        hashBytes(hash, &value, sizeof(value));
+    }
+    return hash;
+}
+
+/**
+ * @brief One line of statistics per grid, the golden file format
+ */
+std::string gridStatistics(const openvdb::GridPtrVec &grids)
+{
+    std::ostringstream stats;
+
+    for (const auto &grid : grids)
+    {
+        const openvdb::CoordBBox bbox = grid->evalActiveVoxelBoundingBox();
+
+        uint64_t checksum = 0;
+        if (auto floatGrid = openvdb::gridConstPtrCast<openvdb::FloatGrid>(grid))
+        {
+            checksum = valueChecksum(*floatGrid);
+        }
+        else if (auto vectorGrid = openvdb::gridConstPtrCast<openvdb::Vec3fGrid>(grid))
+        {
+            checksum = valueChecksum(*vectorGrid);
+        }
+
+        stats << grid->getName() << " voxels " << grid->activeVoxelCount()
+              << " bbox " << bbox.min().x() << " " << bbox.min().y() << " " << bbox.min().z()
+              << " " << bbox.max().x() << " " << bbox.max().y() << " " << bbox.max().z()
+              << " checksum " << std::hex << std::setw(16) << std::setfill('0') << checksum
+              << std::dec << std::setfill(' ') << "\n";
+    }
+
+    return stats.str();
+}
+
+bool readFile(const std::string &path, std::string &contents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+bool writeFile(const std::string &path, const std::string &contents)
+{
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream file(path);
+    file << contents;
+    return static_cast<bool>(file);
+}
+
+int checkGolden(const std::string &goldenPath, const std::string &vdbPath, char *const converter[])
+{
+    std::filesystem::create_directories(std::filesystem::path(vdbPath).parent_path());
+    std::filesystem::remove(vdbPath);
+
+    if (!runConverter(converter))
+    {
+        return 1;
+    }
+
+    openvdb::GridPtrVec grids;
+    try
+    {
+        openvdb::io::File file(vdbPath);
+        file.open();
+        openvdb::GridPtrVecPtr fileGrids = file.getGrids();
+        grids = *fileGrids;
+        file.close();
+    }
+    catch (const openvdb::Exception &exception)
+    {
+        std::cerr << "Error: Could not read " << vdbPath << ": " << exception.what() << std::endl;
+        return 1;
+    }
+
+    const std::string stats = gridStatistics(grids);
+
+    if (recording())
+    {
+        if (!writeFile(goldenPath, stats))
+        {
+            std::cerr << "Error: Could not write " << goldenPath << std::endl;
+            return 1;
+        }
+        std::cout << "Recorded " << goldenPath << std::endl << stats;
+        return 0;
+    }
+
+    std::string golden;
+    if (!readFile(goldenPath, golden))
+    {
+        std::cerr << "Error: No golden file " << goldenPath << "; record it with MULTIVIEW_RECORD=1" << std::endl
+                  << stats;
+        return 1;
+    }
+
+    if (stats != golden)
+    {
+        std::cerr << "Grid statistics differ from " << goldenPath << std::endl
+                  << "expected:" << std::endl << golden
+                  << "actual:" << std::endl << stats;
+        return 1;
+    }
+
+    std::cout << stats;
+    return 0;
+}
+
+/**
+ * @brief Runs the converter with extra options appended, which override earlier ones
+ */
+bool runConverterWith(char *const converter[], std::vector<std::string> extra)
+{
+    std::vector<char *> args;
+    for (char *const *arg = converter; *arg; arg++)
+    {
+        args.push_back(*arg);
+    }
+    for (auto &arg : extra)
+    {
+        args.push_back(&arg[0]);
+    }
+    args.push_back(nullptr);
+    return runConverter(args.data());
+}
+
+/**
+ * @brief Empties a directory, creating it if needed
+ */
+void resetDirectory(const std::string &path)
+{
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+}
+
+int checkIdentical(const std::string &serialDir, const std::string &parallelDir, const std::string &threads,
+                   char *const converter[])
+{
+    resetDirectory(serialDir);
+    resetDirectory(parallelDir);
+
+    // One worker thread and one frame at a time, against as many of both as requested
+    const std::string serialRun = "--threads 1 --jobs 1";
+    const std::string parallelRun = "--threads " + threads + " --jobs " + threads;
+
+    if (!runConverterWith(converter, {"--outdir", serialDir, "--threads", "1", "--jobs", "1"}) ||
+        !runConverterWith(converter, {"--outdir", parallelDir, "--threads", threads, "--jobs", threads}))
+    {
+        return 1;
+    }
+
+    std::vector<std::string> names;
+    for (const auto &entry : std::filesystem::directory_iterator(serialDir))
+    {
+        names.push_back(entry.path().filename().string());
+    }
+    std::sort(names.begin(), names.end());
+
+    const size_t parallelCount = static_cast<size_t>(
+        std::distance(std::filesystem::directory_iterator(parallelDir), std::filesystem::directory_iterator()));
+
+    if (names.empty() || names.size() != parallelCount)
+    {
+        std::cerr << "Error: " << serialRun << " wrote " << names.size() << " files and " << parallelRun
+                  << " wrote " << parallelCount << std::endl;
+        return 1;
+    }
+
+    int differing = 0;
+    for (const auto &name : names)
+    {
+        std::string serial, parallel;
+        if (!readFile(serialDir + "/" + name, serial) || !readFile(parallelDir + "/" + name, parallel) ||
+            serial != parallel)
+        {
+            std::cerr << name << " differs between " << serialRun << " and " << parallelRun << std::endl;
+            differing++;
+        }
+    }
+
+    if (differing > 0)
+    {
+        return 1;
+    }
+
+    std::cout << names.size() << " files identical with " << serialRun << " and " << parallelRun << std::endl;
+    return 0;
+}
+
+int checkPerf(const std::string &baselinePath, double tolerance, int frames, char *const converter[])
+{
+    // The fastest of a few runs is the least disturbed by other load
+    double best = 0.0;
+    for (int run = 0; run < perfRuns; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (!runConverter(converter))
+        {
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    const double perFrame = best / std::max(1, frames);
+
+    if (recording())
+    {
+        std::ostringstream baseline;
+        baseline << "seconds_per_frame " << perFrame << "\n";
+        if (!writeFile(baselinePath, baseline.str()))
+        {
+            std::cerr << "Error: Could not write " << baselinePath << std::endl;
+            return 1;
+        }
+        std::cout << "Recorded " << baselinePath << ": " << perFrame << " s/frame" << std::endl;
+        return 0;
+    }
+
+    std::ifstream baseline(baselinePath);
+    std::string key;
+    double baselinePerFrame = 0.0;
+    if (!(baseline >> key >> baselinePerFrame) || key != "seconds_per_frame" || baselinePerFrame <= 0.0)
+    {
+        std::cerr << "Error: No baseline " << baselinePath << "; record it with MULTIVIEW_RECORD=1 ("
+                  << perFrame << " s/frame)" << std::endl;
+        return 1;
+    }
+
+    const double limit = baselinePerFrame * (1.0 + tolerance);
+    std::cout << std::fixed << std::setprecision(4)
+              << perFrame << " s/frame, baseline " << baselinePerFrame << " s/frame, limit " << limit
+              << " s/frame" << std::endl;
+
+    if (perFrame > limit)
+    {
+        std::cerr << "Per-frame time regressed by " << std::fixed << std::setprecision(1)
+                  << (perFrame / baselinePerFrame - 1.0) * 100.0 << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " golden <golden.txt> <output.vdb> <converter> [options...]\n"
+              << "       " << program << " identical <dir1> <dirN> <threads> <converter> [options...]\n"
+              << "       " << program << " perf <baseline.txt> <tolerance> <frames> <converter> [options...]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 5 && std::strcmp(argv[1], "golden") == 0)
+    {
+        openvdb::initialize();
+        return checkGolden(argv[2], argv[3], argv + 4);
+    }
+
+    if (argc >= 6 && std::strcmp(argv[1], "identical") == 0)
+    {
+        return checkIdentical(argv[2], argv[3], argv[4], argv + 5);
+    }
+
+    if (argc >= 6 && std::strcmp(argv[1], "perf") == 0)
+    {
+        return checkPerf(argv[2], std::stod(argv[3]), std::stoi(argv[4]), argv + 5);
+    }
+
+    printUsage(argv[0]);
+    return 2;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file client.cpp
+ * @brief Submits a conversion job to a running multiview-volume server
+ *
+ * Usage: multiview-volume-client --socket path [conversion options]
+ *
+ * The conversion options are those of multiview-volume. Relative paths in
+ * them are resolved against the client's working directory. Progress is
+ * printed as frames are written; the exit status is 0 if the job succeeded.
+ */
+
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes the whole buffer to the socket
+ */
+bool sendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        const ssize_t length = write(fd, data.data() + sent, data.size() - sent);
+        if (length <= 0)
+        {
+            return false;
+        }
+        sent += static_cast<size_t>(length);
+    }
+    return true;
+}
+
+/**
+ * @brief Prints one reply line of the server
+ * @return true once the final status line has been received, with succeeded set
+ */
+bool handleReply(const std::string &line, bool &succeeded)
+{
+    if (line == "ok" || line == "failed")
+    {
+        succeeded = line == "ok";
+        return true;
+    }
+
+    if (line.compare(0, 6, "frame ") == 0)
+    {
+        std::cout << "Frame " << line.substr(6) << " done" << std::endl;
+    }
+    else if (line.compare(0, 8, "message ") == 0)
+    {
+        std::cerr << line.substr(8) << std::endl;
+    }
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string socketPath;
+
+    // The server resolves relative paths against the first line
+    char workingDir[PATH_MAX];
+    if (getcwd(workingDir, sizeof(workingDir)) == nullptr || strchr(workingDir, '\n'))
+    {
+        std::cerr << "Error: Could not get the working directory" << std::endl;
+        return 1;
+    }
+    std::string request = std::string(workingDir) + "\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+        {
+            socketPath = argv[++i];
+        }
+        else if (argv[i][0] == '\0' || strchr(argv[i], '\n'))
+        {
+            std::cerr << "Error: Arguments must be non-empty single lines" << std::endl;
+            return 1;
+        }
+        else
+        {
+            request += argv[i];
+            request += '\n';
+        }
+    }
+    request += '\n';
+
+    if (socketPath.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --socket path [conversion options]" << std::endl;
+        return 1;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: Socket path is too long: " << socketPath << std::endl;
+        return 1;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        std::cerr << "Error: Could not connect to server: " << socketPath << std::endl;
+        return 1;
+    }
+
+    if (!sendAll(fd, request))
+    {
+        std::cerr << "Error: Could not send the job to " << socketPath << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    // Print the replies line by line until the final status
+    std::string pending;
+    char buffer[4096];
+    bool finished = false;
+    bool succeeded = false;
+
+    while (!finished)
+    {
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            break;
+        }
+        pending.append(buffer, static_cast<size_t>(length));
+
+        size_t newline;
+        while (!finished && (newline = pending.find('\n')) != std::string::npos)
+        {
+            finished = handleReply(pending.substr(0, newline), succeeded);
+            pending.erase(0, newline + 1);
+        }
+    }
+    close(fd);
+
+    if (!finished)
+    {
+        std::cerr << "Error: Connection to the server was lost" << std::endl;
+        return 1;
+    }
+
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,624 @@
+/**
+ * @file synth.cpp
+ * @brief Renders synthetic depth and color views of procedural shapes at any resolution
+ *
+ * Usage: multiview-volume-synth [options]
+ *
+ * Writes the six orthographic cube views of a scene of spheres, tori and
+ * noise-displaced blobs, frame by frame, in the layout multiview-volume
+ * reads: 16-bit RGBA PNG files named NNNNxx.png, with alpha storing one
+ * minus the normalized depth, or raw frames in the shared-memory view
+ * layout of shm.h. The scene is defined in the unit cube and scaled to the
+ * view size, so every size shows the same shapes.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr int viewCount = 6;
+const char *viewNames[viewCount] = {"nx", "ny", "nz", "px", "py", "pz"};
+
+// Shared-memory view layout of shm.h
+constexpr uint32_t sharedFormatVersion = 1;
+
+struct SharedViewsHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t viewCount;
+    uint32_t reserved;
+};
+
+struct SharedViewHeader
+{
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * @struct Vec3
+ * @brief Minimal 3D vector for the scene
+ */
+struct Vec3
+{
+    double x = 0.0, y = 0.0, z = 0.0;
+
+    Vec3() = default;
+    Vec3(double x, double y, double z) : x(x), y(y), z(z) {}
+
+    Vec3 operator+(const Vec3 &o) const { return {x + o.x, y + o.y, z + o.z}; }
+    Vec3 operator-(const Vec3 &o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator*(double s) const { return {x * s, y * s, z * s}; }
+    double dot(const Vec3 &o) const { return x * o.x + y * o.y + z * o.z; }
+    double length() const { return std::sqrt(dot(*this)); }
+};
+
+enum class ShapeType
+{
+    Sphere,
+    Torus,
+    Blob
+};
+
+/**
+ * @struct Shape
+ * @brief One procedural shape; positions and sizes are in unit-cube coordinates
+ */
+struct Shape
+{
+    ShapeType type = ShapeType::Sphere;
+    Vec3 center;
+    double radius = 0.1;      ///< Sphere and blob radius, torus ring radius
+    double thickness = 0.03;  ///< Torus tube radius
+    Vec3 axis{0.0, 0.0, 1.0}; ///< Torus axis
+    double amplitude = 0.2;   ///< Blob displacement relative to the radius
+    double frequency = 20.0;  ///< Blob displacement frequency
+    Vec3 color{1.0, 1.0, 1.0};
+    Vec3 motion;              ///< Displacement amplitude of the periodic motion
+    double phase = 0.0;
+
+    /**
+     * @brief Radius of a sphere around the center enclosing the shape
+     */
+    double bound() const
+    {
+        switch (type)
+        {
+        case ShapeType::Torus:
+            return radius + thickness;
+        case ShapeType::Blob:
+            return radius * (1.0 + amplitude);
+        default:
+            return radius;
+        }
+    }
+
+    /**
+     * @brief Signed distance, or a lower bound of it for blobs
+     */
+    double distance(const Vec3 &p, const Vec3 &c) const
+    {
+        const Vec3 d = p - c;
+
+        switch (type)
+        {
+        case ShapeType::Torus:
+        {
+            const double height = d.dot(axis);
+            const double ring = std::sqrt(std::max(0.0, d.dot(d) - height * height)) - radius;
+            return std::sqrt(ring * ring + height * height) - thickness;
+        }
+        case ShapeType::Blob:
+        {
+            const double noise = std::sin(frequency * d.x + phase) * std::sin(frequency * d.y) *
+                                 std::sin(frequency * d.z + 2.0 * phase);
+
+            // The displacement's gradient is at most radius * amplitude * frequency * sqrt(3)
+            const double lipschitz = 1.0 + radius * amplitude * frequency * std::sqrt(3.0);
+            return (d.length() - radius * (1.0 + amplitude * noise)) / lipschitz;
+        }
+        default:
+            return d.length() - radius;
+        }
+    }
+};
+
+/**
+ * @struct SynthOptions
+ * @brief Command line options of the generator
+ */
+struct SynthOptions
+{
+    int size = 256;
+    int startFrame = 1;
+    int frameCount = 40;
+    std::string outputDir = "synthetic";
+    std::string rawPattern;
+    std::string shapes = "spheres,tori,blobs";
+    int count = 6;
+    unsigned seed = 1;
+    int jobs = 0;
+    bool verbose = false;
+};
+
+/**
+ * @brief Grid position of a pixel at a depth, as cubeRig in src/rig.cpp maps (depth, column, row)
+ */
+Vec3 cubePosition(int viewIndex, double x, double y, double z, double last)
+{
+    switch (viewIndex)
+    {
+    case 0: // NX
+        return {last - x, y, z};
+    case 1: // NY
+        return {last - z, last - y, x};
+    case 2: // NZ
+        return {last - y, last - x, z};
+    case 3: // PX
+        return {x, last - y, z};
+    case 4: // PY
+        return {last - z, y, last - x};
+    default: // PZ
+        return {y, x, z};
+    }
+}
+
+/**
+ * @brief Uniform value in [low, high) from the generator, identical on every platform
+ */
+double uniform(std::mt19937 &random, double low, double high)
+{
+    return low + (high - low) * (random() >> 8) / 16777216.0;
+}
+
+std::vector<Shape> buildScene(const SynthOptions &options)
+{
+    std::vector<ShapeType> types;
+    std::stringstream list(options.shapes);
+    std::string name;
+    while (std::getline(list, name, ','))
+    {
+        if (name == "spheres")
+        {
+            types.push_back(ShapeType::Sphere);
+        }
+        else if (name == "tori")
+        {
+            types.push_back(ShapeType::Torus);
+        }
+        else if (name == "blobs")
+        {
+            types.push_back(ShapeType::Blob);
+        }
+    }
+
+    std::mt19937 random(options.seed);
+    std::vector<Shape> shapes;
+
+    for (int i = 0; i < options.count && !types.empty(); i++)
+    {
+        Shape shape;
+        shape.type = types[i % types.size()];
+        shape.radius = uniform(random, 0.08, 0.18);
+        shape.thickness = shape.radius * uniform(random, 0.2, 0.4);
+        shape.amplitude = uniform(random, 0.1, 0.25);
+        shape.frequency = uniform(random, 15.0, 30.0);
+        shape.color = {uniform(random, 0.2, 1.0), uniform(random, 0.2, 1.0), uniform(random, 0.2, 1.0)};
+        shape.phase = uniform(random, 0.0, 2.0 * M_PI);
+
+        const Vec3 axis(uniform(random, -1.0, 1.0), uniform(random, -1.0, 1.0), uniform(random, -1.0, 1.0));
+        shape.axis = axis.length() > 1e-3 ? axis * (1.0 / axis.length()) : Vec3(0.0, 0.0, 1.0);
+
+        // Shapes and their motion stay clear of the cube faces, where depth 0 marks background
+        const double margin = 0.1 + shape.bound();
+        const double travel = std::max(0.0, 0.5 - margin);
+        shape.motion = {uniform(random, 0.0, 0.5) * travel, uniform(random, 0.0, 0.5) * travel,
+                        uniform(random, 0.0, 0.5) * travel};
+        const double spread = std::max(0.0, 0.5 - margin - 0.5 * travel);
+        shape.center = {0.5 + uniform(random, -spread, spread), 0.5 + uniform(random, -spread, spread),
+                        0.5 + uniform(random, -spread, spread)};
+
+        shapes.push_back(shape);
+    }
+
+    return shapes;
+}
+
+/**
+ * @brief Renders one view into 16-bit RGBA pixels
+ */
+void renderView(const std::vector<Shape> &shapes, int frame, int viewIndex, int size, int jobs,
+                std::vector<uint16_t> &pixels)
+{
+    const double last = size - 1;
+    const double scale = last;
+    const double time = 2.0 * M_PI * frame / 40.0;
+
+    // Centers of this frame, in voxels
+    std::vector<Vec3> centers;
+    for (const auto &shape : shapes)
+    {
+        const Vec3 offset(shape.motion.x * std::sin(time + shape.phase),
+                          shape.motion.y * std::sin(time * 0.7 + 2.0 * shape.phase),
+                          shape.motion.z * std::cos(time * 1.3 + shape.phase));
+        centers.push_back((shape.center + offset) * scale);
+    }
+
+    // Rays run along one grid axis; the step per unit of depth is constant over the view
+    const Vec3 origin = cubePosition(viewIndex, 0, 0, 0, last);
+    const Vec3 direction = cubePosition(viewIndex, 1, 0, 0, last) - origin;
+
+    pixels.assign(static_cast<size_t>(size) * size * 4, 0);
+
+    auto renderRows = [&](int firstRow, int rowStep)
+    {
+        for (int row = firstRow; row < size; row += rowStep)
+        {
+            for (int column = 0; column < size; column++)
+            {
+                const Vec3 start = cubePosition(viewIndex, 0, column, row, last);
+
+                double nearest = last + 1.0;
+                const Shape *hitShape = nullptr;
+                Vec3 hitCenter;
+
+                for (size_t i = 0; i < shapes.size(); i++)
+                {
+                    const Shape &shape = shapes[i];
+
+                    // Interval of the ray inside the bounding sphere
+                    const double bound = shape.bound() * scale + 1.0;
+                    const Vec3 toCenter = centers[i] - start;
+                    const double along = toCenter.dot(direction);
+                    const double gap2 = toCenter.dot(toCenter) - along * along;
+                    if (gap2 > bound * bound)
+                    {
+                        continue;
+                    }
+                    const double half = std::sqrt(bound * bound - gap2);
+                    double t = std::max(0.0, along - half);
+                    const double end = std::min(nearest, along + half);
+
+                    // Sphere tracing in voxels
+                    for (int step = 0; step < 512 && t < end; step++)
+                    {
+                        const Vec3 p = (start + direction * t) * (1.0 / scale);
+                        const double d = shape.distance(p, centers[i] * (1.0 / scale)) * scale;
+                        if (d < 1e-3)
+                        {
+                            nearest = t;
+                            hitShape = &shape;
+                            hitCenter = centers[i] * (1.0 / scale);
+                            break;
+                        }
+                        t += d;
+                    }
+                }
+
+                uint16_t *pixel = &pixels[(static_cast<size_t>(row) * size + column) * 4];
+
+                if (!hitShape)
+                {
+                    // Background sits at depth 0
+                    pixel[3] = 65535;
+                    continue;
+                }
+
+                // Lambert shading from the view direction, normal by central differences
+                const Vec3 p = (start + direction * nearest) * (1.0 / scale);
+                const double h = 0.5 / scale;
+                Vec3 normal(hitShape->distance(p + Vec3(h, 0, 0), hitCenter) - hitShape->distance(p - Vec3(h, 0, 0), hitCenter),
+                            hitShape->distance(p + Vec3(0, h, 0), hitCenter) - hitShape->distance(p - Vec3(0, h, 0), hitCenter),
+                            hitShape->distance(p + Vec3(0, 0, h), hitCenter) - hitShape->distance(p - Vec3(0, 0, h), hitCenter));
+                const double length = normal.length();
+                const double facing = length > 0.0 ? std::max(0.0, -normal.dot(direction) / length) : 1.0;
+                const double shade = 0.35 + 0.65 * facing;
+
+                pixel[0] = static_cast<uint16_t>(std::lround(std::min(1.0, hitShape->color.x * shade) * 65535.0));
+                pixel[1] = static_cast<uint16_t>(std::lround(std::min(1.0, hitShape->color.y * shade) * 65535.0));
+                pixel[2] = static_cast<uint16_t>(std::lround(std::min(1.0, hitShape->color.z * shade) * 65535.0));
+
+                // Alpha is one minus the normalized depth; the top value is reserved for background
+                const double depth = std::min(1.0, nearest / last);
+                pixel[3] = static_cast<uint16_t>(std::min(65534L, std::lround((1.0 - depth) * 65535.0)));
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int job = 0; job < jobs; job++)
+    {
+        threads.emplace_back(renderRows, job, jobs);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+uint32_t crc32(const unsigned char *data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        initialized = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void appendBigEndian(std::string &out, uint32_t value)
+{
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+void appendChunk(std::string &out, const char *type, const std::string &data)
+{
+    appendBigEndian(out, static_cast<uint32_t>(data.size()));
+    const std::string body = std::string(type, 4) + data;
+    out += body;
+    appendBigEndian(out, crc32(reinterpret_cast<const unsigned char *>(body.data()), body.size()));
+}
+
+/**
+ * @brief Writes 16-bit RGBA pixels as a PNG with stored (uncompressed) deflate blocks
+ */
+bool writePng(const std::string &path, const std::vector<uint16_t> &pixels, int size)
+{
+    // Filter byte 0 per row, then big-endian samples
+    std::string raw;
+    raw.reserve(static_cast<size_t>(size) * (size * 8 + 1));
+    for (int row = 0; row < size; row++)
+    {
+        raw.push_back(0);
+        for (int i = 0; i < size * 4; i++)
+        {
+            const uint16_t value = pixels[static_cast<size_t>(row) * size * 4 + i];
+            raw.push_back(static_cast<char>(value >> 8));
+            raw.push_back(static_cast<char>(value & 0xff));
+        }
+    }
+
+    // zlib stream of stored blocks
+    std::string zlib("\x78\x01", 2);
+    uint32_t adlerA = 1, adlerB = 0;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += 65535)
+    {
+        const size_t length = std::min<size_t>(65535, raw.size() - offset);
+        const bool final = offset + length >= raw.size();
+        zlib.push_back(final ? 1 : 0);
+        zlib.push_back(static_cast<char>(length & 0xff));
+        zlib.push_back(static_cast<char>(length >> 8));
+        zlib.push_back(static_cast<char>(~length & 0xff));
+        zlib.push_back(static_cast<char>((~length >> 8) & 0xff));
+        zlib.append(raw, offset, length);
+
+        for (size_t i = offset; i < offset + length; i++)
+        {
+            adlerA = (adlerA + static_cast<unsigned char>(raw[i])) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+    appendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+    std::string header;
+    appendBigEndian(header, static_cast<uint32_t>(size));
+    appendBigEndian(header, static_cast<uint32_t>(size));
+    header += std::string("\x10\x06\x00\x00\x00", 5); // 16-bit RGBA, no interlace
+
+    std::string png("\x89PNG\r\n\x1a\n", 8);
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlib);
+    appendChunk(png, "IEND", std::string());
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(png.data(), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Replaces the printf-style frame field of a pattern, such as %04d
+ */
+std::string expandPattern(const std::string &pattern, int frame)
+{
+    char buffer[4096];
+    std::snprintf(buffer, sizeof(buffer), pattern.c_str(), frame);
+    return buffer;
+}
+
+void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "Options:\n"
+              << "  --size N         Width and height of the views in pixels (default: 256)\n"
+              << "  --start N        First frame number (default: 1)\n"
+              << "  --frames N       Number of frames (default: 40)\n"
+              << "  --outdir dir     Directory of the NNNNxx.png views (default: synthetic)\n"
+              << "  --raw pattern    Write raw frames in the shared-memory view layout instead, e.g.\n"
+              << "                   /dev/shm/views_%04d for --shm-input /views_%04d\n"
+              << "  --shapes list    Comma-separated shape kinds: spheres, tori, blobs (default: all)\n"
+              << "  --count N        Number of shapes (default: 6)\n"
+              << "  --seed N         Scene seed (default: 1)\n"
+              << "  --jobs N         Rendering threads (default: all cores)\n"
+              << "  --verbose        Print each written frame\n"
+              << "  --help           Show this help message\n";
+}
+
+bool parseArguments(int argc, char *argv[], SynthOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            options.size = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc)
+        {
+            options.startFrame = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            options.frameCount = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--outdir") == 0 && i + 1 < argc)
+        {
+            options.outputDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--raw") == 0 && i + 1 < argc)
+        {
+            options.rawPattern = argv[++i];
+        }
+        else if (strcmp(argv[i], "--shapes") == 0 && i + 1 < argc)
+        {
+            options.shapes = argv[++i];
+        }
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+        {
+            options.count = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            options.jobs = std::stoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--verbose") == 0)
+        {
+            options.verbose = true;
+        }
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            printUsage(argv[0]);
+            exit(0);
+        }
+        else
+        {
+            std::cerr << "Error: Unknown option: " << argv[i] << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.size < 2 || options.frameCount < 1)
+    {
+        std::cerr << "Error: --size must be at least 2 and --frames at least 1" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    SynthOptions options;
+    if (!parseArguments(argc, argv, options))
+    {
+        return 1;
+    }
+
+    const int jobs = options.jobs > 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    const std::vector<Shape> shapes = buildScene(options);
+    if (shapes.empty())
+    {
+        std::cerr << "Error: No shapes to render; --shapes takes spheres, tori and blobs" << std::endl;
+        return 1;
+    }
+
+    if (options.rawPattern.empty())
+    {
+        std::filesystem::create_directories(options.outputDir);
+    }
+
+    std::vector<uint16_t> pixels;
+
+    for (int frame = options.startFrame; frame < options.startFrame + options.frameCount; frame++)
+    {
+        if (options.rawPattern.empty())
+        {
+            for (int viewIndex = 0; viewIndex < viewCount; viewIndex++)
+            {
+                renderView(shapes, frame, viewIndex, options.size, jobs, pixels);
+
+                char name[32];
+                std::snprintf(name, sizeof(name), "%04d%s.png", frame, viewNames[viewIndex]);
+                const std::string path = (std::filesystem::path(options.outputDir) / name).string();
+                if (!writePng(path, pixels, options.size))
+                {
+                    std::cerr << "Error: Could not write " << path << std::endl;
+                    return 1;
+                }
+            }
+        }
+        else
+        {
+            const std::string path = expandPattern(options.rawPattern, frame);
+            std::ofstream file(path, std::ios::binary);
+
+            SharedViewsHeader header;
+            std::memcpy(header.magic, "MVVW", 4);
+            header.version = sharedFormatVersion;
+            header.viewCount = viewCount;
+            header.reserved = 0;
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            for (int viewIndex = 0; viewIndex < viewCount; viewIndex++)
+            {
+                renderView(shapes, frame, viewIndex, options.size, jobs, pixels);
+
+                const SharedViewHeader viewHeader{static_cast<uint32_t>(options.size),
+                                                  static_cast<uint32_t>(options.size)};
+                file.write(reinterpret_cast<const char *>(&viewHeader), sizeof(viewHeader));
+                file.write(reinterpret_cast<const char *>(pixels.data()),
+                           static_cast<std::streamsize>(pixels.size() * sizeof(uint16_t)));
+            }
+
+            if (!file)
+            {
+                std::cerr << "Error: Could not write " << path << std::endl;
+                return 1;
+            }
+        }
+
+        if (options.verbose)
+        {
+            std::cout << "Frame " << frame << " written (" << options.size << "x" << options.size << ")" << std::endl;
+        }
+    }
+
+    return 0;
+}